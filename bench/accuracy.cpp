@@ -0,0 +1,182 @@
+#include <cmath>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "autograd.hpp"
+
+using AutoGrad::Dual;
+using AutoGrad::Tape;
+using AutoGrad::Variable;
+
+/* Measures the error of the gradients swept on tapes that store their weights in the type selected when compiling (see
+`AutoGrad::Weight`) against derivatives computed in forward mode, which never rounds them. `make accuracy` builds and
+runs it once per weight type and fails if any error exceeds the bound for that type. */
+namespace {
+
+  /* The Rosenbrock function. */
+  template<typename T>
+  T rosenbrock(std::span<const T> x) {
+    T f = x[0] * 0.0;
+    for (size_t i = 0; i + 1 < x.size(); i++) {
+      T a = x[i + 1] - x[i] * x[i];
+      T b = 1.0 - x[i];
+      f = f + 100.0 * a * a + b * b;
+    }
+    return f;
+  }
+
+  /* The squared error of a multilayer perceptron with 16 inputs and a hidden layer of `tanh` units, whose weights are
+  the arguments. */
+  template<typename T>
+  T perceptron(std::span<const T> x) {
+    constexpr size_t inputs = 16;
+    size_t width = x.size() / (inputs + 1);
+    T output = x[0] * 0.0;
+    for (size_t j = 0; j < width; j++) {
+      T activation = x[j * inputs] * 0.0;
+      for (size_t i = 0; i < inputs; i++) {
+        activation = activation + x[j * inputs + i] * std::cos(static_cast<double>(i + j));
+      }
+      output = output + x[width * inputs + j] * tanh(activation);
+    }
+    return (output - 1.0) * (output - 1.0);
+  }
+
+  /* The log-sum-exp of the arguments, scaled and shifted. */
+  template<typename T>
+  T softmax(std::span<const T> x) {
+    T sum = x[0] * 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+      sum = sum + exp(0.5 * x[i] - 1.0);
+    }
+    return log(sum);
+  }
+
+  /* A sum of operations with a constant operand, whose partial derivatives depend on the constants. */
+  template<typename T>
+  T constants(std::span<const T> x) {
+    T f = x[0] * 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+      f = f + pow(1.001, x[i]) + log(x[i], 1.7) + 3.3 / x[i];
+    }
+    return f;
+  }
+
+  /* A sum of hyperbolic secants, whose Hessian is diagonal. */
+  template<typename T>
+  T secants(std::span<const T> x) {
+    T f = x[0] * 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+      f = f + sech(x[i]);
+    }
+    return f;
+  }
+
+  /* A pendulum integrated over many steps, whose arguments are its length and initial angle (so that each path from an
+  argument to the result has many edges). */
+  template<typename T>
+  T pendulum(std::span<const T> x) {
+    T angle = x[1];
+    T velocity = x[1] * 0.0;
+    for (size_t step = 0; step < 10000; step++) {
+      velocity = velocity - 9.81 / x[0] * sin(angle) * 0.001;
+      angle = angle + velocity * 0.001;
+    }
+    return angle * angle;
+  }
+
+  /* Largest relative error allowed for the weight type selected when compiling (lazy tapes always store their weights
+  in full, see `AutoGrad::Weight`). */
+  double bound(Tape<double>::Mode mode) {
+    if (mode == Tape<double>::Mode::Lazy || sizeof(AutoGrad::Weight<double>) == sizeof(double)) {
+      return 1e-12;
+    }
+    return (sizeof(AutoGrad::Weight<double>) == sizeof(float)) ? 1e-5 : 3e-2;
+  }
+
+  /* Measure the largest error of the gradient of the given function at the given arguments on a tape in the given mode,
+  relative to the largest partial derivative (as computed in forward mode), and print it with the memory used by the
+  tape per node. Return whether the error is within the bound for the weight type. */
+  template<typename Function>
+  bool measure(const std::string &name, Function function, const std::vector<double> &arguments, Tape<double>::Mode mode) {
+    Tape<double> tape(mode);
+    std::vector<Variable<double>> variables;
+    variables.reserve(arguments.size());
+    for (double argument : arguments) {
+      variables.push_back(tape.variable(argument));
+    }
+    Variable<double> result = function(std::span<const Variable<double>>(variables));
+    AutoGrad::Gradient<double> gradient = result.gradient();
+    std::vector<double> reference(arguments.size());
+    double scale = 0.0;
+    for (size_t input = 0; input < arguments.size(); input++) {
+      std::vector<Dual<double, 1>> duals;
+      duals.reserve(arguments.size());
+      for (size_t i = 0; i < arguments.size(); i++) {
+        duals.push_back((i == input) ? Dual<double, 1>(arguments[i], 0) : Dual<double, 1>(arguments[i]));
+      }
+      reference[input] = function(std::span<const Dual<double, 1>>(duals)).derivative(0);
+      scale = std::max(scale, std::abs(reference[input]));
+    }
+    double error = 0.0;
+    for (size_t input = 0; input < arguments.size(); input++) {
+      error = std::max(error, std::abs(gradient.withRespectTo(variables[input]) - reference[input]) / scale);
+    }
+    Tape<double>::Statistics statistics = tape.statistics();
+    double bytes = static_cast<double>(statistics.bytes) / static_cast<double>(statistics.nodes);
+    bool within = error <= bound(mode);
+    const char *kind = (mode == Tape<double>::Mode::Lazy) ? "lazy" : "eager";
+    std::printf("  %-12s %-6s %8zu nodes  %6.2f bytes/node  relative error %.3e%s\n", name.c_str(), kind, statistics.nodes, bytes, error, within ? "" : "  (exceeds bound)");
+    return within;
+  }
+
+  /* Measure the largest error of the Hessian of `secants()` at the given arguments, which is recorded on a tape of dual
+  numbers (see `AutoGrad::hessian()`), relative to its largest entry, and print it. Return whether the error is within
+  the bound for full weights (which tapes of dual numbers always store). */
+  bool curvature(const std::vector<double> &arguments) {
+    AutoGrad::Hessian<double> hessian = AutoGrad::hessian<double>([](auto x) { return secants(x); }, std::span<const double>(arguments));
+    std::vector<double> reference(arguments.size());
+    double scale = 0.0;
+    for (size_t input = 0; input < arguments.size(); input++) {
+      double tangent = std::tanh(arguments[input]);
+      double secant = 1.0 / std::cosh(arguments[input]);
+      reference[input] = secant * (tangent * tangent - secant * secant);
+      scale = std::max(scale, std::abs(reference[input]));
+    }
+    double error = 0.0;
+    for (size_t row = 0; row < arguments.size(); row++) {
+      for (size_t column = 0; column < arguments.size(); column++) {
+        error = std::max(error, std::abs(hessian(row, column) - ((row == column) ? reference[row] : 0.0)) / scale);
+      }
+    }
+    bool within = error <= bound(Tape<double>::Mode::Lazy);
+    std::printf("  %-12s %-6s %8zu inputs                      relative error %.3e%s\n", "secants", "hessian", arguments.size(), error, within ? "" : "  (exceeds bound)");
+    return within;
+  }
+
+  /* Retrieve arguments spread over the given interval. */
+  std::vector<double> arguments(size_t size, double low, double high) {
+    std::vector<double> values(size);
+    for (size_t i = 0; i < size; i++) {
+      values[i] = low + (high - low) * (0.5 + 0.5 * std::sin(static_cast<double>(i) * 12.9898));
+    }
+    return values;
+  }
+}
+
+int main() {
+  std::printf("Weights stored in %zu bytes:\n", sizeof(AutoGrad::Weight<double>));
+  bool within = true;
+  for (Tape<double>::Mode mode : {Tape<double>::Mode::Eager, Tape<double>::Mode::Lazy}) {
+    within &= measure("rosenbrock", [](auto x) { return rosenbrock(x); }, arguments(1000, -1.5, 1.5), mode);
+    within &= measure("perceptron", [](auto x) { return perceptron(x); }, arguments(32 * 17, -0.5, 0.5), mode);
+    within &= measure("softmax", [](auto x) { return softmax(x); }, arguments(1000, -4.0, 4.0), mode);
+    within &= measure("constants", [](auto x) { return constants(x); }, arguments(1000, 0.5, 2.0), mode);
+    within &= measure("secants", [](auto x) { return secants(x); }, arguments(1000, -3.0, 3.0), mode);
+    within &= measure("pendulum", [](auto x) { return pendulum(x); }, std::vector<double>{1.0, 0.5}, mode);
+  }
+  within &= curvature(arguments(64, -3.0, 3.0));
+  return within ? 0 : 1;
+}
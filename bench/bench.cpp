@@ -0,0 +1,339 @@
+#include <cmath>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "autograd.hpp"
+
+using AutoGrad::Tape;
+using AutoGrad::Variable;
+
+namespace {
+  constexpr size_t operations = 4096; // Number of operations recorded per iteration of the recording benchmarks.
+
+  /* Report the nodes per second and bytes per node of the tape (recorded once per iteration). */
+  void report(benchmark::State &state, const Tape<double> &tape) {
+    Tape<double>::Statistics statistics = tape.statistics();
+    state.counters["nodes/s"] = benchmark::Counter(static_cast<double>(statistics.nodes), benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["bytes/node"] = static_cast<double>(statistics.bytes) / static_cast<double>(std::max<size_t>(statistics.nodes, 1));
+  }
+
+  /* Record a chain of the given unary operation. */
+  template<typename Operation>
+  void recordUnary(benchmark::State &state, Operation operation) {
+    Tape<double> tape;
+    for (auto _ : state) {
+      tape.clear();
+      Variable<double> x = tape.variable(0.5);
+      for (size_t i = 0; i < operations; i++) {
+        x = operation(x);
+      }
+      benchmark::DoNotOptimize(x.value());
+    }
+    report(state, tape);
+  }
+
+  /* Record a chain of the given binary operation on variables. */
+  template<typename Operation>
+  void recordBinary(benchmark::State &state, Operation operation) {
+    Tape<double> tape;
+    for (auto _ : state) {
+      tape.clear();
+      Variable<double> x = tape.variable(0.5);
+      Variable<double> y = tape.variable(1.5);
+      for (size_t i = 0; i < operations; i++) {
+        x = operation(x, y);
+      }
+      benchmark::DoNotOptimize(x.value());
+    }
+    report(state, tape);
+  }
+
+  void recordAddition(benchmark::State &state) {
+    recordBinary(state, [](const Variable<double> &x, const Variable<double> &y) { return x + y; });
+  }
+
+  void recordMultiplication(benchmark::State &state) {
+    recordBinary(state, [](const Variable<double> &x, const Variable<double> &y) { return x * y; });
+  }
+
+  void recordDivision(benchmark::State &state) {
+    recordBinary(state, [](const Variable<double> &x, const Variable<double> &y) { return x / y; });
+  }
+
+  void recordPower(benchmark::State &state) {
+    recordBinary(state, [](const Variable<double> &x, const Variable<double> &y) { return AutoGrad::pow(x, y); });
+  }
+
+  void recordScalar(benchmark::State &state) {
+    recordUnary(state, [](const Variable<double> &x) { return x * 0.999 + 0.001; });
+  }
+
+  void recordExponential(benchmark::State &state) {
+    recordUnary(state, [](const Variable<double> &x) { return AutoGrad::log(AutoGrad::exp(x)); });
+  }
+
+  void recordTrigonometric(benchmark::State &state) {
+    recordUnary(state, [](const Variable<double> &x) { return AutoGrad::sin(x); });
+  }
+
+  void recordHyperbolic(benchmark::State &state) {
+    recordUnary(state, [](const Variable<double> &x) { return AutoGrad::tanh(x); });
+  }
+
+  void recordFused(benchmark::State &state) {
+    recordBinary(state, [](const Variable<double> &x, const Variable<double> &y) -> Variable<double> { return AutoGrad::fuse(x) * y + AutoGrad::sin(AutoGrad::fuse(x)); });
+  }
+
+  /* Record products of square matrices (each recorded as a kernel rather than as edges). */
+  void recordMatrix(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    std::vector<double> values(size * size, 0.5);
+    Tape<double> tape;
+    for (auto _ : state) {
+      tape.clear();
+      AutoGrad::Matrix<double> a = tape.matrix(size, size, values);
+      AutoGrad::Matrix<double> b = tape.matrix(size, size, values);
+      AutoGrad::Matrix<double> c = tanh(matmul(a, b));
+      benchmark::DoNotOptimize(c.value(0, 0));
+    }
+    report(state, tape);
+  }
+
+  /* Evaluate the given function of a span over a range of arguments (to compare `AutoGrad::FastMath` with the standard
+  functions). */
+  template<typename Function>
+  void elementary(benchmark::State &state, Function function) {
+    std::vector<double> x(operations), y(operations);
+    for (size_t i = 0; i < operations; i++) {
+      x[i] = 0.001 + 4.0 * static_cast<double>(i) / static_cast<double>(operations);
+    }
+    for (auto _ : state) {
+      function(std::span<const double>(x), std::span<double>(y));
+      benchmark::DoNotOptimize(y.data());
+    }
+    state.counters["calls/s"] = benchmark::Counter(static_cast<double>(operations), benchmark::Counter::kIsIterationInvariantRate);
+  }
+
+  void standardExponential(benchmark::State &state) {
+    elementary(state, [](std::span<const double> x, std::span<double> y) {
+      for (size_t i = 0; i < x.size(); i++) {
+        y[i] = std::exp(x[i]);
+      }
+    });
+  }
+
+  void fastExponential(benchmark::State &state) {
+    elementary(state, [](std::span<const double> x, std::span<double> y) { AutoGrad::FastMath::exp(x, y); });
+  }
+
+  void standardLogarithm(benchmark::State &state) {
+    elementary(state, [](std::span<const double> x, std::span<double> y) {
+      for (size_t i = 0; i < x.size(); i++) {
+        y[i] = std::log(x[i]);
+      }
+    });
+  }
+
+  void fastLogarithm(benchmark::State &state) {
+    elementary(state, [](std::span<const double> x, std::span<double> y) { AutoGrad::FastMath::log(x, y); });
+  }
+
+  void standardHyperbolic(benchmark::State &state) {
+    elementary(state, [](std::span<const double> x, std::span<double> y) {
+      for (size_t i = 0; i < x.size(); i++) {
+        y[i] = std::tanh(x[i]);
+      }
+    });
+  }
+
+  void fastHyperbolic(benchmark::State &state) {
+    elementary(state, [](std::span<const double> x, std::span<double> y) { AutoGrad::FastMath::tanh(x, y); });
+  }
+
+  /* Sweep a tape of the given number of nodes (recorded once) in the given mode. */
+  void sweep(benchmark::State &state, Tape<double>::Mode mode) {
+    size_t nodes = static_cast<size_t>(state.range(0));
+    Tape<double> tape(mode);
+    Variable<double> x = tape.variable(0.5);
+    Variable<double> y = tape.variable(1.5);
+    Variable<double> z = x;
+    while (tape.statistics().nodes < nodes) {
+      z = AutoGrad::sin(z) * y + x;
+    }
+    for (auto _ : state) {
+      AutoGrad::Gradient<double> gradient = z.gradient();
+      benchmark::DoNotOptimize(gradient.withRespectTo(x));
+    }
+    report(state, tape);
+  }
+
+  void sweepEager(benchmark::State &state) {
+    sweep(state, Tape<double>::Mode::Eager);
+  }
+
+  void sweepLazy(benchmark::State &state) {
+    sweep(state, Tape<double>::Mode::Lazy);
+  }
+
+  /* Copy variables around (each copy is recorded as a node unless `AUTOGRAD_ALIAS_COPIES` is defined). */
+  void copies(benchmark::State &state) {
+    Tape<double> tape;
+    for (auto _ : state) {
+      tape.clear();
+      std::vector<Variable<double>> variables;
+      variables.reserve(64);
+      for (size_t i = 0; i < 64; i++) {
+        variables.push_back(tape.variable(static_cast<double>(i)));
+      }
+      for (size_t round = 0; round < operations / 64; round++) {
+        std::vector<Variable<double>> previous = variables;
+        for (size_t i = 0; i < variables.size(); i++) {
+          variables[i] = previous[(i + 1) % previous.size()];
+        }
+      }
+      benchmark::DoNotOptimize(variables[0].value());
+    }
+    report(state, tape);
+  }
+
+  /* Record and differentiate the Rosenbrock function of the given number of variables. */
+  void rosenbrock(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    Tape<double> tape;
+    for (auto _ : state) {
+      tape.clear();
+      std::vector<Variable<double>> x;
+      x.reserve(size);
+      for (size_t i = 0; i < size; i++) {
+        x.push_back(tape.variable(0.5 + 0.001 * static_cast<double>(i)));
+      }
+      Variable<double> f = tape.variable(0.0);
+      for (size_t i = 0; i + 1 < size; i++) {
+        Variable<double> a = x[i + 1] - x[i] * x[i];
+        Variable<double> b = 1.0 - x[i];
+        f = f + 100.0 * a * a + b * b;
+      }
+      AutoGrad::Gradient<double> gradient = f.gradient();
+      benchmark::DoNotOptimize(gradient.withRespectTo(x[0]));
+    }
+    report(state, tape);
+  }
+
+  /* Record and differentiate the squared error of a multilayer perceptron with a hidden layer of the given width. */
+  void perceptron(benchmark::State &state) {
+    size_t inputs = 32;
+    size_t width = static_cast<size_t>(state.range(0));
+    Tape<double> tape;
+    for (auto _ : state) {
+      tape.clear();
+      std::vector<Variable<double>> weights;
+      weights.reserve(width * (inputs + 1));
+      for (size_t i = 0; i < width * (inputs + 1); i++) {
+        weights.push_back(tape.variable(std::sin(static_cast<double>(i)) * 0.1));
+      }
+      Variable<double> output = tape.variable(0.0);
+      for (size_t j = 0; j < width; j++) {
+        Variable<double> activation = tape.variable(0.0);
+        for (size_t i = 0; i < inputs; i++) {
+          activation = activation + weights[j * inputs + i] * (static_cast<double>(i) / static_cast<double>(inputs));
+        }
+        output = output + weights[width * inputs + j] * AutoGrad::tanh(activation);
+      }
+      Variable<double> loss = (output - 1.0) * (output - 1.0);
+      AutoGrad::Gradient<double> gradient = loss.gradient();
+      benchmark::DoNotOptimize(gradient.withRespectTo(weights[0]));
+    }
+    report(state, tape);
+  }
+
+  /* Compute per-sample gradients of a small function over a batch of the given number of samples, recording one tape
+  per sample. */
+  void samples(benchmark::State &state) {
+    size_t batch = static_cast<size_t>(state.range(0));
+    Tape<double> tape;
+    for (auto _ : state) {
+      for (size_t sample = 0; sample < batch; sample++) {
+        tape.clear();
+        Variable<double> x = tape.variable(0.001 * static_cast<double>(sample));
+        Variable<double> y = tape.variable(1.0);
+        Variable<double> z = x * y;
+        for (size_t i = 0; i < 64; i++) {
+          z = AutoGrad::tanh(z * y + x);
+        }
+        AutoGrad::Gradient<double> gradient = z.gradient();
+        benchmark::DoNotOptimize(gradient.withRespectTo(x));
+      }
+    }
+    state.counters["samples/s"] = benchmark::Counter(static_cast<double>(batch), benchmark::Counter::kIsIterationInvariantRate);
+  }
+
+  /* Compute the same per-sample gradients on a `BatchTape`. */
+  void batched(benchmark::State &state) {
+    size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<double> values(batch);
+    for (size_t sample = 0; sample < batch; sample++) {
+      values[sample] = 0.001 * static_cast<double>(sample);
+    }
+    AutoGrad::BatchTape<double> tape(batch);
+    for (auto _ : state) {
+      tape.clear();
+      AutoGrad::BatchVariable<double> x = tape.variable(values);
+      AutoGrad::BatchVariable<double> y = tape.variable(1.0);
+      AutoGrad::BatchVariable<double> z = x * y;
+      for (size_t i = 0; i < 64; i++) {
+        z = tanh(z * y + x);
+      }
+      AutoGrad::BatchGradient<double> gradient = z.gradient();
+      benchmark::DoNotOptimize(gradient.withRespectTo(x)[0]);
+    }
+    state.counters["samples/s"] = benchmark::Counter(static_cast<double>(batch), benchmark::Counter::kIsIterationInvariantRate);
+  }
+
+  /* Differentiate a pendulum integrated over the given number of steps with `AutoGrad::rollout()`. */
+  void rollout(benchmark::State &state) {
+    size_t steps = static_cast<size_t>(state.range(0));
+    std::vector<double> parameters = {9.81};
+    std::vector<double> initial = {1.0, 0.0};
+    auto step = [](Tape<double> &, std::span<const Variable<double>> p, std::span<const Variable<double>> x, size_t) {
+      return std::vector<Variable<double>>{x[0] + x[1] * 0.001, x[1] - p[0] * AutoGrad::sin(x[0]) * 0.001};
+    };
+    auto loss = [](Tape<double> &, std::span<const Variable<double>>, std::span<const Variable<double>> x) {
+      return x[0] * x[0];
+    };
+    size_t evaluations = 0;
+    for (auto _ : state) {
+      AutoGrad::Rollout<double> result = AutoGrad::rollout<double>(step, loss, parameters, initial, steps, 32);
+      evaluations = result.evaluations();
+      benchmark::DoNotOptimize(result.withRespectToParameters()[0]);
+    }
+    state.counters["evaluations/step"] = static_cast<double>(evaluations) / static_cast<double>(steps);
+  }
+}
+
+BENCHMARK(recordAddition);
+BENCHMARK(recordMultiplication);
+BENCHMARK(recordDivision);
+BENCHMARK(recordPower);
+BENCHMARK(recordScalar);
+BENCHMARK(recordExponential);
+BENCHMARK(recordTrigonometric);
+BENCHMARK(recordHyperbolic);
+BENCHMARK(recordFused);
+BENCHMARK(recordMatrix)->Arg(16)->Arg(64);
+BENCHMARK(standardExponential);
+BENCHMARK(fastExponential);
+BENCHMARK(standardLogarithm);
+BENCHMARK(fastLogarithm);
+BENCHMARK(standardHyperbolic);
+BENCHMARK(fastHyperbolic);
+BENCHMARK(sweepEager)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(sweepLazy)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(copies);
+BENCHMARK(rosenbrock)->Arg(1000)->Arg(100000);
+BENCHMARK(perceptron)->Arg(64)->Arg(256);
+BENCHMARK(samples)->Arg(1024);
+BENCHMARK(batched)->Arg(1024);
+BENCHMARK(rollout)->Arg(10000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,135 @@
+#ifndef AUTOGRAD_ARENA_HPP
+#define AUTOGRAD_ARENA_HPP
+
+
+#include "utils.hpp"
+
+/* Number of elements per block of an `AutoGrad::Arena` (must be a power of two). */
+#ifndef AUTOGRAD_BLOCK_SIZE
+#define AUTOGRAD_BLOCK_SIZE 4096
+#endif
+
+namespace AutoGrad {
+
+  /* A memory resource whose memory may have to be read in before it can be accessed (e.g. from a file, see
+  `AutoGrad::MappedResource`) and that can be asked to start doing so ahead of time. */
+  class PrefetchingResource : public std::pmr::memory_resource {
+  public:
+    /* Start reading in the given range of memory allocated from the resource, without waiting for it. */
+    virtual void prefetch(const void *address, size_t bytes) const noexcept = 0;
+  };
+
+  /* A sequence of elements stored in fixed-size blocks obtained from a memory resource. Unlike `std::vector`, growing
+  the sequence only ever allocates one more block and never moves the elements already stored, so appending an element
+  takes constant time in the worst case (not just amortized) and no more than one block of memory is left unused. The
+  memory resource can be any `std::pmr::memory_resource` (e.g. a `std::pmr::monotonic_buffer_resource` over a
+  preallocated or huge-page backed buffer); blocks are kept when the sequence is truncated so that they can be reused.
+  If it is a `PrefetchingResource`, ranges of elements can be prefetched. */
+  template<typename T>
+  class Arena {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "`T` must be trivially copyable and destructible");
+    static_assert(std::has_single_bit(static_cast<size_t>(AUTOGRAD_BLOCK_SIZE)), "`AUTOGRAD_BLOCK_SIZE` must be a power of two");
+
+  public:
+    /* Construct an empty arena that allocates its blocks from the given memory resource. */
+    explicit Arena(std::pmr::memory_resource *resource_ = std::pmr::get_default_resource()) noexcept : resource{resource_}, prefetcher{dynamic_cast<const PrefetchingResource *>(resource_)} {} // Constructor
+
+    // Disallow copy semantics
+    Arena(const Arena<T> &arena) = delete; // Copy constructor
+    Arena<T> &operator=(const Arena<T> &arena) = delete; // Copy assignment operator
+
+    /* Construct a new arena by moving the given one, which is left empty. */
+    Arena(Arena<T> &&arena) noexcept : resource{arena.resource}, prefetcher{arena.prefetcher}, blocks{std::exchange(arena.blocks, {})}, count{std::exchange(arena.count, 0)} {} // Move constructor
+
+    /* Assign a new arena by moving the given one, which is left empty. */
+    Arena<T> &operator=(Arena<T> &&arena) noexcept { // Move assignment operator
+      if (this != &arena) {
+        release();
+        resource = arena.resource;
+        prefetcher = arena.prefetcher;
+        blocks = std::exchange(arena.blocks, {});
+        count = std::exchange(arena.count, 0);
+      }
+      return *this;
+    }
+
+    /* Destroy the arena, returning its blocks to the memory resource. */
+    ~Arena() { // Destructor
+      release();
+    }
+
+    /* Access the element at the given position. */
+    T &operator[](size_t position) noexcept {
+      return blocks[position / block][position % block];
+    }
+
+    /* Access the element at the given position. */
+    const T &operator[](size_t position) const noexcept {
+      return blocks[position / block][position % block];
+    }
+
+    /* Retrieve the number of elements. */
+    size_t size() const noexcept {
+      return count;
+    }
+
+    /* Retrieve the number of elements that fit in the blocks allocated so far. */
+    size_t capacity() const noexcept {
+      return blocks.size() * block;
+    }
+
+    /* Append an element, allocating a new block if every block is full. */
+    void push_back(const T &element) {
+      if (count == blocks.size() * block) {
+        blocks.push_back(nullptr);
+        try {
+          blocks.back() = static_cast<T *>(resource->allocate(block * sizeof(T), alignof(T)));
+        } catch (...) {
+          blocks.pop_back();
+          throw;
+        }
+      }
+      std::construct_at(&(*this)[count], element);
+      count++;
+    }
+
+    /* Ask the memory resource to start reading in the elements in the given range of positions, if it is a
+    `PrefetchingResource` (otherwise this does nothing). */
+    void prefetch(size_t begin, size_t end) const noexcept {
+      if (prefetcher == nullptr) {
+        return;
+      }
+      end = std::min(end, count);
+      while (begin < end) {
+        size_t stop = std::min(end, (begin / block + 1) * block);
+        prefetcher->prefetch(&(*this)[begin], (stop - begin) * sizeof(T));
+        begin = stop;
+      }
+    }
+
+    /* Discard every element from the given position on, keeping the blocks. */
+    void truncate(size_t position) noexcept {
+      count = std::min(count, position);
+    }
+
+  private:
+    static constexpr size_t block = AUTOGRAD_BLOCK_SIZE; // Number of elements per block.
+
+    std::pmr::memory_resource *resource; // Memory resource that the blocks are allocated from.
+    const PrefetchingResource *prefetcher; // The memory resource if it supports prefetching (or null).
+    std::vector<T *> blocks; // Blocks in order (only these pointers move when the arena grows, never the elements).
+    size_t count = 0; // Number of elements.
+
+    /* Return every block to the memory resource. */
+    void release() noexcept {
+      for (T *pointer : blocks) {
+        resource->deallocate(pointer, block * sizeof(T), alignof(T));
+      }
+      blocks.clear();
+      count = 0;
+    }
+  };
+}
+
+
+#endif // AUTOGRAD_ARENA_HPP
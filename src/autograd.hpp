@@ -3,11 +3,31 @@
 #define AUTOGRAD_AUTOGRAD_HPP
 
 
+#include "arena.hpp"
+#include "batch.hpp"
+#include "checkpoint.hpp"
+#include "constant.hpp"
+#include "dual.hpp"
+#include "expression.hpp"
+#include "fastmath.hpp"
 #include "gradient.hpp"
-#include "node.hpp"
+#include "hessian.hpp"
+#include "instrument.hpp"
+#include "jacobian.hpp"
+#include "kernel.hpp"
+#include "mapped.hpp"
+#include "matrix.hpp"
+#include "opcode.hpp"
+#include "operations.hpp"
+#include "parallel.hpp"
+#include "program.hpp"
+#include "saved.hpp"
+#include "schedule.hpp"
+#include "scope.hpp"
 #include "tape.hpp"
 #include "utils.hpp"
 #include "variable.hpp"
+#include "weight.hpp"
 
 namespace AutoGrad {
 
@@ -16,85 +36,73 @@ namespace AutoGrad {
   /* Addition. */
   template<FloatingPoint S>
   Variable<S> operator+(const Variable<S> &variable1, const Variable<S> &variable2) {
-    if (&variable1.tape != &variable2.tape) {
-      throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
-    }
-    return Variable<S>(variable1.tape, variable1.val + variable2.val, variable1.tape.push_back(1.0, variable1.index, 1.0, variable2.index));
+    return variable1.tape.template apply<Operations::Addition>(variable1, variable2);
   }
 
   /* Addition. */
   template<FloatingPoint S>
-  Variable<S> operator+(const Variable<S> &variable, S scalar) {
-    return Variable<S>(variable.tape, variable.val + scalar, variable.tape.push_back(1.0, variable.index));
+  Variable<S> operator+(const Variable<S> &variable, std::type_identity_t<S> scalar) {
+    return variable.tape.template apply<Operations::Addition>(variable, scalar);
   }
 
   /* Addition. */
   template<FloatingPoint S>
-  Variable<S> operator+(S scalar, const Variable<S> &variable) {
+  Variable<S> operator+(std::type_identity_t<S> scalar, const Variable<S> &variable) {
     return variable + scalar;
   }
 
   /* Subtraction. */
   template<FloatingPoint S>
   Variable<S> operator-(const Variable<S> &variable1, const Variable<S> &variable2) {
-    if (&variable1.tape != &variable2.tape) {
-      throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
-    }
-    return Variable<S>(variable1.tape, variable1.val - variable2.val, variable1.tape.push_back(1.0, variable1.index, -1.0, variable2.index));
+    return variable1.tape.template apply<Operations::Subtraction>(variable1, variable2);
   }
 
   /* Subtraction. */
   template<FloatingPoint S>
-  Variable<S> operator-(const Variable<S> &variable, S scalar) {
-    return Variable<S>(variable.tape, variable.val - scalar, variable.tape.push_back(1.0, variable.index));
+  Variable<S> operator-(const Variable<S> &variable, std::type_identity_t<S> scalar) {
+    return variable.tape.template apply<Operations::Subtraction>(variable, scalar);
   }
 
   /* Subtraction. */
   template<FloatingPoint S>
-  Variable<S> operator-(S scalar, const Variable<S> &variable) {
-    return Variable<S>(variable.tape, scalar - variable.val, variable.tape.push_back(-1.0, variable.index));
+  Variable<S> operator-(std::type_identity_t<S> scalar, const Variable<S> &variable) {
+    return variable.tape.template apply<Operations::Subtraction>(scalar, variable);
   }
 
   /* Multiplication. */
   template<FloatingPoint S>
   Variable<S> operator*(const Variable<S> &variable1, const Variable<S> &variable2) {
-    if (&variable1.tape != &variable2.tape) {
-      throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
-    }
-    return Variable<S>(variable1.tape, variable1.val * variable2.val, variable1.tape.push_back(variable2.val, variable1.index, variable1.val, variable2.index));
+    return variable1.tape.template apply<Operations::Multiplication>(variable1, variable2);
   }
 
   /* Multiplication. */
   template<FloatingPoint S>
-  Variable<S> operator*(const Variable<S> &variable, S scalar) {
-    return Variable<S>(variable.tape, variable.val * scalar, variable.tape.push_back(scalar, variable.index));
+  Variable<S> operator*(const Variable<S> &variable, std::type_identity_t<S> scalar) {
+    return variable.tape.template apply<Operations::Multiplication>(variable, scalar);
   }
 
   /* Multiplication. */
   template<FloatingPoint S>
-  Variable<S> operator*(S scalar, const Variable<S> &variable) {
+  Variable<S> operator*(std::type_identity_t<S> scalar, const Variable<S> &variable) {
     return variable * scalar;
   }
 
   /* Division. */
   template<FloatingPoint S>
   Variable<S> operator/(const Variable<S> &variable1, const Variable<S> &variable2) {
-    if (&variable1.tape != &variable2.tape) {
-      throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
-    }
-    return Variable<S>(variable1.tape, variable1.val / variable2.val, variable1.tape.push_back(1.0 / variable2.val, variable1.index, -variable1.val / (variable2.val * variable2.val), variable2.index));
+    return variable1.tape.template apply<Operations::Division>(variable1, variable2);
   }
 
   /* Division. */
   template<FloatingPoint S>
-  Variable<S> operator/(const Variable<S> &variable, S scalar) {
-    return Variable<S>(variable.tape, variable.val / scalar, variable.tape.push_back(1.0 / scalar, variable.index));
+  Variable<S> operator/(const Variable<S> &variable, std::type_identity_t<S> scalar) {
+    return variable.tape.template apply<Operations::Division>(variable, scalar);
   }
 
   /* Division. */
   template<FloatingPoint S>
-  Variable<S> operator/(S scalar, const Variable<S> &variable) {
-    return Variable<S>(variable.tape, scalar / variable.val, variable.tape.push_back(-scalar / (variable.val * variable.val), variable.index));
+  Variable<S> operator/(std::type_identity_t<S> scalar, const Variable<S> &variable) {
+    return variable.tape.template apply<Operations::Division>(scalar, variable);
   }
 
   // Exponentiation and logarithmic functions
@@ -102,73 +110,67 @@ namespace AutoGrad {
   /* Exponentiation (powers). */
   template<FloatingPoint S>
   Variable<S> pow(const Variable<S> &variable1, const Variable<S> &variable2) {
-    if (&variable1.tape != &variable2.tape) {
-      throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
-    }
-    return Variable<S>(variable1.tape, std::pow(variable1.val, variable2.val), variable1.tape.push_back(variable2.val * std::pow(variable1.val, variable2.val - 1), variable1.index, std::log(variable1.val) * std::pow(variable1.val, variable2.val), variable2.index));
+    return variable1.tape.template apply<Operations::Power>(variable1, variable2);
   }
 
   /* Exponentiation (powers). */
   template<FloatingPoint S>
-  Variable<S> pow(const Variable<S> &variable, S scalar) {
-    return Variable<S>(variable.tape, std::pow(variable.val, scalar), variable.tape.push_back(scalar * std::pow(variable.val, scalar - 1), variable.index));
+  Variable<S> pow(const Variable<S> &variable, std::type_identity_t<S> scalar) {
+    return variable.tape.template apply<Operations::Power>(variable, scalar);
   }
 
   /* Exponentiation (powers). */
   template<FloatingPoint S>
-  Variable<S> pow(S scalar, const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::pow(scalar, variable.val), variable.tape.push_back(std::log(scalar) * std::pow(scalar, variable.val), variable.index));
+  Variable<S> pow(std::type_identity_t<S> scalar, const Variable<S> &variable) {
+    return variable.tape.template apply<Operations::Power>(scalar, variable);
   }
 
   /* Square root. */
   template<FloatingPoint S>
   Variable<S> sqrt(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::sqrt(variable.val), variable.tape.push_back(0.5 / std::sqrt(variable.val), variable.index));
+    return variable.tape.template apply<Operations::SquareRoot>(variable);
   }
 
   /* Cube root. */
   template<FloatingPoint S>
   Variable<S> cbrt(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::cbrt(variable.val), variable.tape.push_back(1.0 / (3.0 * std::cbrt(variable.val) * std::cbrt(variable.val)), variable.index));
+    return variable.tape.template apply<Operations::CubeRoot>(variable);
   }
 
   /* Exponential function. */
   template<FloatingPoint S>
   Variable<S> exp(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::exp(variable.val), variable.tape.push_back(std::exp(variable.val), variable.index));
+    return variable.tape.template apply<Operations::Exponential>(variable);
   }
 
   /* Base-2 exponential function. */
   template<FloatingPoint S>
   Variable<S> exp2(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::exp2(variable.val), variable.tape.push_back(std::exp2(variable.val) * std::log(2), variable.index));
+    return variable.tape.template apply<Operations::BinaryExponential>(variable);
   }
 
   /* Natural logarithm. */
   template<FloatingPoint S>
   Variable<S> log(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::log(variable.val), variable.tape.push_back(1.0 / variable.val, variable.index));
+    return variable.tape.template apply<Operations::NaturalLogarithm>(variable);
   }
 
   /* Logarithm with a specified base. */
   template<FloatingPoint S>
   Variable<S> log(const Variable<S> &variable, const Variable<S> &base) {
-    if (&variable.tape != &base.tape) {
-      throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
-    }
-    return Variable<S>(variable.tape, std::log(variable.val) / std::log(base.val), variable.tape.push_back(1.0 / (variable.val * std::log(base.val)), variable.index, -std::log(variable.val) / (base.val * std::log(base.val) * std::log(base.val)), base.index));
+    return variable.tape.template apply<Operations::Logarithm>(variable, base);
   }
 
   /* Logarithm with a specified base. */
   template<FloatingPoint S>
-  Variable<S> log(const Variable<S> &variable, S base) {
-    return Variable<S>(variable.tape, std::log(variable.val) / std::log(base), variable.tape.push_back(1.0 / (variable.val * std::log(base)), variable.index));
+  Variable<S> log(const Variable<S> &variable, std::type_identity_t<S> base) {
+    return variable.tape.template apply<Operations::Logarithm>(variable, base);
   }
 
   /* Logarithm with a specified base. */
   template<FloatingPoint S>
-  Variable<S> log(S scalar, const Variable<S> &base) {
-    return Variable<S>(base.tape, std::log(scalar) / std::log(base.val), base.tape.push_back(-std::log(scalar) / (base.val * std::log(base.val) * std::log(base.val)), base.index));
+  Variable<S> log(std::type_identity_t<S> scalar, const Variable<S> &base) {
+    return base.tape.template apply<Operations::Logarithm>(scalar, base);
   }
 
   /* Natural logarithm. */
@@ -180,13 +182,13 @@ namespace AutoGrad {
   /* Base-2 logarithm. */
   template<FloatingPoint S>
   Variable<S> log2(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::log2(variable.val), variable.tape.push_back(1.0 / (variable.val * std::log(2)), variable.index));
+    return variable.tape.template apply<Operations::BinaryLogarithm>(variable);
   }
 
   /* Base-10 logarithm. */
   template<FloatingPoint S>
   Variable<S> log10(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::log10(variable.val), variable.tape.push_back(1.0 / (variable.val * std::log(10)), variable.index));
+    return variable.tape.template apply<Operations::CommonLogarithm>(variable);
   }
 
   // Trigonometric functions
@@ -194,73 +196,73 @@ namespace AutoGrad {
   /* Sine. */
   template<FloatingPoint S>
   Variable<S> sin(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::sin(variable.val), variable.tape.push_back(std::cos(variable.val), variable.index));
+    return variable.tape.template apply<Operations::Sine>(variable);
   }
 
   /* Cosine. */
   template<FloatingPoint S>
   Variable<S> cos(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::cos(variable.val), variable.tape.push_back(-std::sin(variable.val), variable.index));
+    return variable.tape.template apply<Operations::Cosine>(variable);
   }
 
   /* Tangent. */
   template<FloatingPoint S>
   Variable<S> tan(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::tan(variable.val), variable.tape.push_back(1.0 / (std::cos(variable.val) * std::cos(variable.val)), variable.index));
+    return variable.tape.template apply<Operations::Tangent>(variable);
   }
 
   /* Secant. */
   template<FloatingPoint S>
   Variable<S> sec(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, 1.0 / std::cos(variable.val), variable.tape.push_back(std::tan(variable.val) / std::cos(variable.val), variable.index));
+    return variable.tape.template apply<Operations::Secant>(variable);
   }
 
   /* Cosecant. */
   template<FloatingPoint S>
   Variable<S> csc(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, 1.0 / std::sin(variable.val), variable.tape.push_back(-std::cos(variable.val) / (std::sin(variable.val) * std::sin(variable.val)), variable.index));
+    return variable.tape.template apply<Operations::Cosecant>(variable);
   }
 
   /* Cotangent. */
   template<FloatingPoint S>
   Variable<S> cot(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, 1.0 / std::tan(variable.val), variable.tape.push_back(-1.0 / (std::sin(variable.val) * std::sin(variable.val)), variable.index));
+    return variable.tape.template apply<Operations::Cotangent>(variable);
   }
 
   /* Inverse sine. */
   template<FloatingPoint S>
   Variable<S> arcsin(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::asin(variable.val), variable.tape.push_back(1.0 / std::sqrt(1.0 - variable.val * variable.val), variable.index));
+    return variable.tape.template apply<Operations::InverseSine>(variable);
   }
 
   /* Inverse cosine. */
   template<FloatingPoint S>
   Variable<S> arccos(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::acos(variable.val), variable.tape.push_back(-1.0 / std::sqrt(1.0 - variable.val * variable.val), variable.index));
+    return variable.tape.template apply<Operations::InverseCosine>(variable);
   }
 
   /* Inverse tangent. */
   template<FloatingPoint S>
   Variable<S> arctan(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::atan(variable.val), variable.tape.push_back(1.0 / (1.0 + variable.val * variable.val), variable.index));
+    return variable.tape.template apply<Operations::InverseTangent>(variable);
   }
 
   /* Inverse secant. */
   template<FloatingPoint S>
   Variable<S> arcsec(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::acos(1.0 / variable.val), variable.tape.push_back(-1.0 / (std::abs(variable.val) * std::sqrt(variable.val * variable.val - 1.0)), variable.index));
+    return variable.tape.template apply<Operations::InverseSecant>(variable);
   }
 
   /* Inverse cosecant. */
   template<FloatingPoint S>
   Variable<S> arccsc(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::asin(1.0 / variable.val), variable.tape.push_back(-1.0 / (std::abs(variable.val) * std::sqrt(variable.val * variable.val - 1.0)), variable.index));
+    return variable.tape.template apply<Operations::InverseCosecant>(variable);
   }
 
   /* Inverse cotangent. */
   template<FloatingPoint S>
   Variable<S> arccot(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, (variable.val >= 0) ? (std::atan(1.0 / variable.val)) : (std::atan(1.0 / variable.val) + std::numbers::pi_v<S>), variable.tape.push_back(-1.0 / (1.0 + variable.val * variable.val), variable.index));
+    return variable.tape.template apply<Operations::InverseCotangent>(variable);
   }
 
   // Hyperbolic trigonometric functions
@@ -268,79 +270,79 @@ namespace AutoGrad {
   /* Hyperbolic sine. */
   template<FloatingPoint S>
   Variable<S> sinh(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::sinh(variable.val), variable.tape.push_back(std::cosh(variable.val), variable.index));
+    return variable.tape.template apply<Operations::HyperbolicSine>(variable);
   }
 
   /* Hyperbolic cosine. */
   template<FloatingPoint S>
   Variable<S> cosh(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::cosh(variable.val), variable.tape.push_back(std::sinh(variable.val), variable.index));
+    return variable.tape.template apply<Operations::HyperbolicCosine>(variable);
   }
 
   /* Hyperbolic tangent. */
   template<FloatingPoint S>
   Variable<S> tanh(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::tanh(variable.val), variable.tape.push_back(1.0 - std::tanh(variable.val) * std::tanh(variable.val), variable.index));
+    return variable.tape.template apply<Operations::HyperbolicTangent>(variable);
   }
 
   /* Hyperbolic secant. */
   template<FloatingPoint S>
   Variable<S> sech(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, 1.0 / std::cosh(variable.val), variable.tape.push_back(-std::tanh(variable.val) / std::cosh(variable.val), variable.index));
+    return variable.tape.template apply<Operations::HyperbolicSecant>(variable);
   }
 
   /* Hyperbolic cosecant. */
   template<FloatingPoint S>
   Variable<S> csch(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, 1.0 / std::sinh(variable.val), variable.tape.push_back(-std::cosh(variable.val) / (std::sinh(variable.val) * std::sinh(variable.val)), variable.index));
+    return variable.tape.template apply<Operations::HyperbolicCosecant>(variable);
   }
 
   /* Hyperbolic cotangent. */
   template<FloatingPoint S>
   Variable<S> coth(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, 1.0 / std::tanh(variable.val), variable.tape.push_back(-1.0 / (std::sinh(variable.val) * std::sinh(variable.val)), variable.index));
+    return variable.tape.template apply<Operations::HyperbolicCotangent>(variable);
   }
 
   /* Inverse hyperbolic sine. */
   template<FloatingPoint S>
   Variable<S> arsinh(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::asinh(variable.val), variable.tape.push_back(1.0 / std::sqrt(variable.val * variable.val + 1.0), variable.index));
+    return variable.tape.template apply<Operations::InverseHyperbolicSine>(variable);
   }
 
   /* Inverse hyperbolic cosine. */
   template<FloatingPoint S>
   Variable<S> arcosh(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::acosh(variable.val), variable.tape.push_back(1.0 / std::sqrt(variable.val * variable.val - 1.0), variable.index));
+    return variable.tape.template apply<Operations::InverseHyperbolicCosine>(variable);
   }
 
   /* Inverse hyperbolic tangent. */
   template<FloatingPoint S>
   Variable<S> artanh(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::atanh(variable.val), variable.tape.push_back(1.0 / (1.0 - variable.val * variable.val), variable.index));
+    return variable.tape.template apply<Operations::InverseHyperbolicTangent>(variable);
   }
 
   /* Inverse hyperbolic secant. */
   template<FloatingPoint S>
   Variable<S> arsech(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::acosh(1.0 / variable.val), variable.tape.push_back(-1.0 / (std::abs(variable.val) * std::sqrt(1.0 - variable.val * variable.val)), variable.index));
+    return variable.tape.template apply<Operations::InverseHyperbolicSecant>(variable);
   }
 
   /* Inverse hyperbolic cosecant. */
   template<FloatingPoint S>
   Variable<S> arcsch(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::asinh(1.0 / variable.val), variable.tape.push_back(-1.0 / (std::abs(variable.val) * std::sqrt(1.0 + variable.val * variable.val)), variable.index));
+    return variable.tape.template apply<Operations::InverseHyperbolicCosecant>(variable);
   }
 
   /* Inverse hyperbolic cotangent. */
   template<FloatingPoint S>
   Variable<S> arcoth(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::atanh(1.0 / variable.val), variable.tape.push_back(1.0 / (1.0 - variable.val * variable.val), variable.index));
+    return variable.tape.template apply<Operations::InverseHyperbolicCotangent>(variable);
   }
 
   /* Absolute value. */
   template<FloatingPoint S>
   Variable<S> abs(const Variable<S> &variable) {
-    return Variable<S>(variable.tape, std::abs(variable.val), variable.tape.push_back(std::abs(variable.val) / variable.val, variable.index));
+    return variable.tape.template apply<Operations::AbsoluteValue>(variable);
   }
 }
 
@@ -0,0 +1,522 @@
+#ifndef AUTOGRAD_BATCH_HPP
+#define AUTOGRAD_BATCH_HPP
+
+
+#include "operations.hpp"
+#include "utils.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class BatchVariable; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class BatchGradient; // Forward declaration
+
+  /* A gradient tape that evaluates the same function at a fixed number of samples at once (e.g. the loss of each example
+  of a minibatch, to get per-sample gradients). Each node stores its dependencies once, together with the values and
+  partial derivatives of all samples contiguously, so a batch of `n` samples records as many nodes and indices as a
+  single sample instead of `n` times as many, and the forward operations and the reverse sweep are loops over the
+  samples that the compiler can vectorize. The function must not branch on the values of the samples. */
+  template<FloatingPoint Scalar>
+  class BatchTape {
+    friend class BatchVariable<Scalar>;
+    friend class BatchGradient<Scalar>;
+
+  public:
+    /* Construct a new tape object for the given number of samples. */
+    explicit BatchTape(size_t samples_) : width{samples_} { // Constructor
+      if (width == 0) {
+        throw std::invalid_argument("Number of samples of an `AutoGrad::BatchTape` must be positive");
+      }
+    }
+
+    // Disallow copy semantics
+    // Each tape has variables bound to that specific reference so copying tapes would lead to weird behavior.
+    BatchTape(const BatchTape<Scalar> &tape) = delete; // Copy constructor
+    BatchTape<Scalar> &operator=(const BatchTape<Scalar> &tape) = delete; // Copy assignment operator
+
+    /* Retrieve the number of samples. */
+    size_t samples() const noexcept {
+      return width;
+    }
+
+    /* Retrieve the number of nodes in the computational graph. */
+    size_t size() const noexcept {
+      return offsets.size();
+    }
+
+    /* Construct a new variable with the given value for each sample. */
+    BatchVariable<Scalar> variable(std::span<const Scalar> values) {
+      if (values.size() != width) {
+        throw std::invalid_argument("Number of values of an `AutoGrad::BatchVariable` does not match the number of samples");
+      }
+      Index index = open(0);
+      std::copy(values.begin(), values.end(), vals.begin() + static_cast<std::ptrdiff_t>(index * width));
+      return BatchVariable<Scalar>(*this, index);
+    }
+
+    /* Construct a new variable with the same value for every sample. */
+    BatchVariable<Scalar> variable(Scalar value) {
+      Index index = open(0);
+      std::fill_n(vals.begin() + static_cast<std::ptrdiff_t>(index * width), width, value);
+      return BatchVariable<Scalar>(*this, index);
+    }
+
+    /* Discard every node (and so invalidate every variable bound to the tape), keeping the allocated memory. */
+    void clear() noexcept {
+      offsets.clear();
+      dependencies.clear();
+      weights.clear();
+      vals.clear();
+    }
+
+  private:
+    // The computational graph is stored in compressed sparse row form as in `AutoGrad::Tape`, except that each node has
+    // `width` values and each edge `width` weights, stored contiguously.
+    size_t width; // Number of samples.
+    std::vector<Index> offsets; // Position of each node's first edge.
+    std::vector<Index> dependencies; // Index of the parent node along each edge.
+    std::vector<Scalar> weights; // Partial derivative along each edge for each sample (edge-major).
+    std::vector<Scalar> vals; // Value of each node for each sample (node-major).
+
+    /* Append a node with the given number of edges (whose dependencies, weights and values are to be filled in by the
+    caller) and return its index. */
+    Index open(size_t edges) {
+      if (offsets.size() >= std::numeric_limits<Index>::max() || dependencies.size() + edges > std::numeric_limits<Index>::max()) {
+        throw std::length_error("`AutoGrad::BatchTape` exceeds the range of `AutoGrad::Index` (define `AUTOGRAD_WIDE_INDICES`)");
+      }
+      Index index = static_cast<Index>(offsets.size());
+      offsets.push_back(static_cast<Index>(dependencies.size()));
+      dependencies.resize(dependencies.size() + edges);
+      weights.resize(weights.size() + edges * width);
+      vals.resize(vals.size() + width);
+      return index;
+    }
+
+    /* Propagate the adjoints of every sample (which must already be seeded) backwards through the computational graph
+    from the node with the given start index, in the same way as `Tape::sweep()`. */
+    void sweep(std::vector<Scalar> &adjoints, Index start) const {
+      size_t end = (static_cast<size_t>(start) + 1 < offsets.size()) ? offsets[start + 1] : dependencies.size();
+      for (size_t i = start; i > 0; i--) {
+        size_t begin = offsets[i];
+        const Scalar *adjoint = adjoints.data() + i * width;
+        for (size_t edge = begin; edge < end; edge++) {
+          Scalar *target = adjoints.data() + dependencies[edge] * width;
+          const Scalar *weight = weights.data() + edge * width;
+          for (size_t sample = 0; sample < width; sample++) {
+            target[sample] += weight[sample] * adjoint[sample];
+          }
+        }
+        end = begin;
+      }
+    }
+  };
+
+  /* A variable of a `BatchTape`, with a value for each sample. Variables are immutable handles, so copying one does not
+  record anything and refers to the same node. */
+  template<FloatingPoint Scalar>
+  class BatchVariable {
+    friend class BatchTape<Scalar>;
+    friend class BatchGradient<Scalar>;
+
+    // Operations on variables are defined as (non-template) friends so that they are found through argument-dependent
+    // lookup and scalars are implicitly converted to `Scalar`.
+
+    // Arithmetic operations
+
+    /* Addition. */
+    friend BatchVariable<Scalar> operator+(const BatchVariable<Scalar> &variable1, const BatchVariable<Scalar> &variable2) {
+      return binary<Operations::Addition>(variable1, variable2);
+    }
+
+    /* Addition. */
+    friend BatchVariable<Scalar> operator+(const BatchVariable<Scalar> &variable, Scalar scalar) {
+      return constant<Operations::Addition, false>(variable, scalar);
+    }
+
+    /* Addition. */
+    friend BatchVariable<Scalar> operator+(Scalar scalar, const BatchVariable<Scalar> &variable) {
+      return constant<Operations::Addition, true>(variable, scalar);
+    }
+
+    /* Subtraction. */
+    friend BatchVariable<Scalar> operator-(const BatchVariable<Scalar> &variable1, const BatchVariable<Scalar> &variable2) {
+      return binary<Operations::Subtraction>(variable1, variable2);
+    }
+
+    /* Subtraction. */
+    friend BatchVariable<Scalar> operator-(const BatchVariable<Scalar> &variable, Scalar scalar) {
+      return constant<Operations::Subtraction, false>(variable, scalar);
+    }
+
+    /* Subtraction. */
+    friend BatchVariable<Scalar> operator-(Scalar scalar, const BatchVariable<Scalar> &variable) {
+      return constant<Operations::Subtraction, true>(variable, scalar);
+    }
+
+    /* Multiplication. */
+    friend BatchVariable<Scalar> operator*(const BatchVariable<Scalar> &variable1, const BatchVariable<Scalar> &variable2) {
+      return binary<Operations::Multiplication>(variable1, variable2);
+    }
+
+    /* Multiplication. */
+    friend BatchVariable<Scalar> operator*(const BatchVariable<Scalar> &variable, Scalar scalar) {
+      return constant<Operations::Multiplication, false>(variable, scalar);
+    }
+
+    /* Multiplication. */
+    friend BatchVariable<Scalar> operator*(Scalar scalar, const BatchVariable<Scalar> &variable) {
+      return constant<Operations::Multiplication, true>(variable, scalar);
+    }
+
+    /* Division. */
+    friend BatchVariable<Scalar> operator/(const BatchVariable<Scalar> &variable1, const BatchVariable<Scalar> &variable2) {
+      return binary<Operations::Division>(variable1, variable2);
+    }
+
+    /* Division. */
+    friend BatchVariable<Scalar> operator/(const BatchVariable<Scalar> &variable, Scalar scalar) {
+      return constant<Operations::Division, false>(variable, scalar);
+    }
+
+    /* Division. */
+    friend BatchVariable<Scalar> operator/(Scalar scalar, const BatchVariable<Scalar> &variable) {
+      return constant<Operations::Division, true>(variable, scalar);
+    }
+
+    /* Negation. */
+    friend BatchVariable<Scalar> operator-(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::Negation>(variable);
+    }
+
+    // Exponential and logarithmic functions
+
+    /* Exponentiation (powers). */
+    friend BatchVariable<Scalar> pow(const BatchVariable<Scalar> &variable1, const BatchVariable<Scalar> &variable2) {
+      return binary<Operations::Power>(variable1, variable2);
+    }
+
+    /* Exponentiation (powers). */
+    friend BatchVariable<Scalar> pow(const BatchVariable<Scalar> &variable, Scalar scalar) {
+      return constant<Operations::Power, false>(variable, scalar);
+    }
+
+    /* Exponentiation (powers). */
+    friend BatchVariable<Scalar> pow(Scalar scalar, const BatchVariable<Scalar> &variable) {
+      return constant<Operations::Power, true>(variable, scalar);
+    }
+
+    /* Square root. */
+    friend BatchVariable<Scalar> sqrt(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::SquareRoot>(variable);
+    }
+
+    /* Cube root. */
+    friend BatchVariable<Scalar> cbrt(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::CubeRoot>(variable);
+    }
+
+    /* Exponential function. */
+    friend BatchVariable<Scalar> exp(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::Exponential>(variable);
+    }
+
+    /* Base-2 exponential function. */
+    friend BatchVariable<Scalar> exp2(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::BinaryExponential>(variable);
+    }
+
+    /* Natural logarithm. */
+    friend BatchVariable<Scalar> log(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::NaturalLogarithm>(variable);
+    }
+
+    /* Natural logarithm. */
+    friend BatchVariable<Scalar> ln(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::NaturalLogarithm>(variable);
+    }
+
+    /* Base-2 logarithm. */
+    friend BatchVariable<Scalar> log2(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::BinaryLogarithm>(variable);
+    }
+
+    /* Base-10 logarithm. */
+    friend BatchVariable<Scalar> log10(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::CommonLogarithm>(variable);
+    }
+
+    /* Logarithm with a specified base. */
+    friend BatchVariable<Scalar> log(const BatchVariable<Scalar> &variable1, const BatchVariable<Scalar> &variable2) {
+      return binary<Operations::Logarithm>(variable1, variable2);
+    }
+
+    /* Logarithm with a specified base. */
+    friend BatchVariable<Scalar> log(const BatchVariable<Scalar> &variable, Scalar scalar) {
+      return constant<Operations::Logarithm, false>(variable, scalar);
+    }
+
+    /* Logarithm with a specified base. */
+    friend BatchVariable<Scalar> log(Scalar scalar, const BatchVariable<Scalar> &variable) {
+      return constant<Operations::Logarithm, true>(variable, scalar);
+    }
+
+    // Trigonometric functions
+
+    /* Sine. */
+    friend BatchVariable<Scalar> sin(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::Sine>(variable);
+    }
+
+    /* Cosine. */
+    friend BatchVariable<Scalar> cos(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::Cosine>(variable);
+    }
+
+    /* Tangent. */
+    friend BatchVariable<Scalar> tan(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::Tangent>(variable);
+    }
+
+    /* Secant. */
+    friend BatchVariable<Scalar> sec(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::Secant>(variable);
+    }
+
+    /* Cosecant. */
+    friend BatchVariable<Scalar> csc(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::Cosecant>(variable);
+    }
+
+    /* Cotangent. */
+    friend BatchVariable<Scalar> cot(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::Cotangent>(variable);
+    }
+
+    /* Inverse sine. */
+    friend BatchVariable<Scalar> arcsin(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseSine>(variable);
+    }
+
+    /* Inverse cosine. */
+    friend BatchVariable<Scalar> arccos(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseCosine>(variable);
+    }
+
+    /* Inverse tangent. */
+    friend BatchVariable<Scalar> arctan(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseTangent>(variable);
+    }
+
+    /* Inverse secant. */
+    friend BatchVariable<Scalar> arcsec(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseSecant>(variable);
+    }
+
+    /* Inverse cosecant. */
+    friend BatchVariable<Scalar> arccsc(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseCosecant>(variable);
+    }
+
+    /* Inverse cotangent. */
+    friend BatchVariable<Scalar> arccot(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseCotangent>(variable);
+    }
+
+    // Hyperbolic functions
+
+    /* Hyperbolic sine. */
+    friend BatchVariable<Scalar> sinh(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::HyperbolicSine>(variable);
+    }
+
+    /* Hyperbolic cosine. */
+    friend BatchVariable<Scalar> cosh(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::HyperbolicCosine>(variable);
+    }
+
+    /* Hyperbolic tangent. */
+    friend BatchVariable<Scalar> tanh(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::HyperbolicTangent>(variable);
+    }
+
+    /* Hyperbolic secant. */
+    friend BatchVariable<Scalar> sech(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::HyperbolicSecant>(variable);
+    }
+
+    /* Hyperbolic cosecant. */
+    friend BatchVariable<Scalar> csch(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::HyperbolicCosecant>(variable);
+    }
+
+    /* Hyperbolic cotangent. */
+    friend BatchVariable<Scalar> coth(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::HyperbolicCotangent>(variable);
+    }
+
+    /* Inverse hyperbolic sine. */
+    friend BatchVariable<Scalar> arsinh(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseHyperbolicSine>(variable);
+    }
+
+    /* Inverse hyperbolic cosine. */
+    friend BatchVariable<Scalar> arcosh(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseHyperbolicCosine>(variable);
+    }
+
+    /* Inverse hyperbolic tangent. */
+    friend BatchVariable<Scalar> artanh(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseHyperbolicTangent>(variable);
+    }
+
+    /* Inverse hyperbolic secant. */
+    friend BatchVariable<Scalar> arsech(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseHyperbolicSecant>(variable);
+    }
+
+    /* Inverse hyperbolic cosecant. */
+    friend BatchVariable<Scalar> arcsch(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseHyperbolicCosecant>(variable);
+    }
+
+    /* Inverse hyperbolic cotangent. */
+    friend BatchVariable<Scalar> arcoth(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::InverseHyperbolicCotangent>(variable);
+    }
+
+    /* Absolute value. */
+    friend BatchVariable<Scalar> abs(const BatchVariable<Scalar> &variable) {
+      return unary<Operations::AbsoluteValue>(variable);
+    }
+
+  public:
+    /* Retrieve the value for the given sample. */
+    Scalar value(size_t sample) const {
+      if (sample >= tape->width) {
+        throw std::out_of_range("Sample out of range of the `AutoGrad::BatchTape`");
+      }
+      return tape->vals[index * tape->width + sample];
+    }
+
+    /* Retrieve the values for all samples (valid until the next operation is recorded on the tape). */
+    std::span<const Scalar> values() const noexcept {
+      return std::span<const Scalar>(tape->vals.data() + index * tape->width, tape->width);
+    }
+
+    /* Compute the gradient of each sample: the partial derivatives with respect to all input variables. */
+    BatchGradient<Scalar> gradient() const {
+      size_t width = tape->width;
+      std::vector<Scalar> adjoints(tape->size() * width, 0.0);
+      std::fill_n(adjoints.begin() + static_cast<std::ptrdiff_t>(index * width), width, 1.0);
+      tape->sweep(adjoints, index);
+      return BatchGradient<Scalar>(*tape, std::move(adjoints));
+    }
+
+  private:
+    BatchTape<Scalar> *tape; // Tape that the variable is recorded on.
+    Index index; // Index of the node.
+
+    /* Construct a variable for the node with the given index. */
+    BatchVariable(BatchTape<Scalar> &tape_, Index index_) noexcept : tape{&tape_}, index{index_} {} // Constructor
+
+    /* Ensure that two variables are from the same tape. */
+    static void check(const BatchVariable<Scalar> &variable1, const BatchVariable<Scalar> &variable2) {
+      if (variable1.tape != variable2.tape) {
+        throw std::invalid_argument("`AutoGrad::BatchVariable`s not from the same `AutoGrad::BatchTape`");
+      }
+    }
+
+    /* Apply a unary operation (see `AutoGrad::Operations`) to each sample. */
+    template<typename Operation>
+    static BatchVariable<Scalar> unary(const BatchVariable<Scalar> &variable) {
+      BatchTape<Scalar> &tape_ = *variable.tape;
+      size_t width = tape_.width;
+      Index index_ = tape_.open(1);
+      size_t edge = tape_.offsets[index_];
+      tape_.dependencies[edge] = variable.index;
+      const Scalar *x = tape_.vals.data() + variable.index * width;
+      Scalar *value = tape_.vals.data() + index_ * width;
+      Scalar *weight = tape_.weights.data() + edge * width;
+      Operations::evaluate<Operation>(std::span<const Scalar>(x, width), std::span<Scalar>(value, width), std::span<Scalar>(weight, width));
+      return BatchVariable<Scalar>(tape_, index_);
+    }
+
+    /* Apply a binary operation (see `AutoGrad::Operations`) to two variables, sample by sample. */
+    template<typename Operation>
+    static BatchVariable<Scalar> binary(const BatchVariable<Scalar> &variable1, const BatchVariable<Scalar> &variable2) {
+      check(variable1, variable2);
+      BatchTape<Scalar> &tape_ = *variable1.tape;
+      size_t width = tape_.width;
+      Index index_ = tape_.open(2);
+      size_t edge = tape_.offsets[index_];
+      tape_.dependencies[edge] = variable1.index;
+      tape_.dependencies[edge + 1] = variable2.index;
+      const Scalar *x = tape_.vals.data() + variable1.index * width;
+      const Scalar *y = tape_.vals.data() + variable2.index * width;
+      Scalar *value = tape_.vals.data() + index_ * width;
+      Scalar *left = tape_.weights.data() + edge * width;
+      Scalar *right = left + width;
+      for (size_t sample = 0; sample < width; sample++) {
+        value[sample] = Operation::value(x[sample], y[sample]);
+        left[sample] = Operation::left(x[sample], y[sample], value[sample]);
+        right[sample] = Operation::right(x[sample], y[sample], value[sample]);
+      }
+      return BatchVariable<Scalar>(tape_, index_);
+    }
+
+    /* Apply a binary operation (see `AutoGrad::Operations`) to a variable and a scalar, which is the right operand
+    unless `Reversed` is true, sample by sample. */
+    template<typename Operation, bool Reversed>
+    static BatchVariable<Scalar> constant(const BatchVariable<Scalar> &variable, Scalar scalar) {
+      BatchTape<Scalar> &tape_ = *variable.tape;
+      size_t width = tape_.width;
+      Index index_ = tape_.open(1);
+      size_t edge = tape_.offsets[index_];
+      tape_.dependencies[edge] = variable.index;
+      const Scalar *x = tape_.vals.data() + variable.index * width;
+      Scalar *value = tape_.vals.data() + index_ * width;
+      Scalar *weight = tape_.weights.data() + edge * width;
+      for (size_t sample = 0; sample < width; sample++) {
+        if constexpr (Reversed) {
+          value[sample] = Operation::value(scalar, x[sample]);
+          weight[sample] = Operation::right(scalar, x[sample], value[sample]);
+        } else {
+          value[sample] = Operation::value(x[sample], scalar);
+          weight[sample] = Operation::left(x[sample], scalar, value[sample]);
+        }
+      }
+      return BatchVariable<Scalar>(tape_, index_);
+    }
+  };
+
+  /* Contains the gradient of each sample of a batch variable (see `BatchVariable::gradient()`): the partial
+  derivatives of the output variable with respect to all input variables. */
+  template<FloatingPoint Scalar>
+  class BatchGradient {
+    friend class BatchVariable<Scalar>;
+
+  public:
+    /* Retrieve the partial derivatives with respect to the given variable, one for each sample. */
+    std::span<const Scalar> withRespectTo(const BatchVariable<Scalar> &variable) const {
+      if (tape != variable.tape) {
+        throw std::invalid_argument("`AutoGrad::BatchVariable` not from the same `AutoGrad::BatchTape` as `AutoGrad::BatchGradient`");
+      }
+      if (variable.index >= gradients.size() / tape->width) {
+        return zeros;
+      }
+      return std::span<const Scalar>(gradients.data() + variable.index * tape->width, tape->width);
+    }
+
+  private:
+    const BatchTape<Scalar> *tape; // Tape of the gradient.
+    std::vector<Scalar> gradients; // Partial derivatives with respect to each node for each sample (node-major).
+    std::vector<Scalar> zeros; // Partial derivatives with respect to variables recorded after the output.
+
+    /* Construct a gradient object from the adjoints of the given tape. */
+    BatchGradient(const BatchTape<Scalar> &tape_, std::vector<Scalar> gradients_) : tape{&tape_}, gradients(std::move(gradients_)), zeros(tape_.width, 0.0) {} // Constructor
+  };
+}
+
+
+#endif // AUTOGRAD_BATCH_HPP
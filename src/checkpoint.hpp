@@ -0,0 +1,253 @@
+#ifndef AUTOGRAD_CHECKPOINT_HPP
+#define AUTOGRAD_CHECKPOINT_HPP
+
+
+#include "scope.hpp"
+#include "tape.hpp"
+#include "utils.hpp"
+#include "variable.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class Rollout; // Forward declaration
+
+  template<FloatingPoint Scalar, typename Step, typename Loss>
+  Rollout<Scalar> rollout(Step step, Loss loss, std::span<const Scalar> parameters, std::span<const Scalar> state, size_t steps, size_t checkpoints); // Forward declaration
+
+  /* Contains the value and gradient of a loss at the end of a rollout (see `AutoGrad::rollout()`): the partial
+  derivatives with respect to the parameters and to the initial state. */
+  template<FloatingPoint Scalar>
+  class Rollout {
+    template<FloatingPoint S, typename Step, typename Loss>
+    friend Rollout<S> rollout(Step step, Loss loss, std::span<const S> parameters, std::span<const S> state, size_t steps, size_t checkpoints);
+
+  public:
+
+    /* Retrieve the value of the loss. */
+    Scalar value() const noexcept {
+      return val;
+    }
+
+    /* Retrieve the partial derivatives of the loss with respect to the parameters. */
+    std::span<const Scalar> withRespectToParameters() const noexcept {
+      return parameterAdjoints;
+    }
+
+    /* Retrieve the partial derivatives of the loss with respect to the initial state. */
+    std::span<const Scalar> withRespectToState() const noexcept {
+      return stateAdjoints;
+    }
+
+    /* Retrieve the number of times that a step was evaluated (including the recomputations). */
+    size_t evaluations() const noexcept {
+      return count;
+    }
+
+  private:
+    Scalar val = 0.0; // Value of the loss.
+    std::vector<Scalar> parameterAdjoints; // Partial derivative with respect to each parameter.
+    std::vector<Scalar> stateAdjoints; // Partial derivative with respect to each element of the initial state.
+    size_t count = 0; // Number of evaluations of a step.
+
+    /* Construct a rollout object for the given numbers of parameters and elements of the state. */
+    Rollout(size_t parameters, size_t elements) : parameterAdjoints(parameters, 0.0), stateAdjoints(elements, 0.0) {} // Constructor
+
+    /* Record the given variables as new leaves of the tape. */
+    static std::vector<Variable<Scalar>> leaves(Tape<Scalar> &tape, std::span<const Scalar> values) {
+      std::vector<Variable<Scalar>> variables;
+      variables.reserve(values.size());
+      for (Scalar value : values) {
+        variables.push_back(tape.variable(value));
+      }
+      return variables;
+    }
+
+    /* Call a step and check that it returns a state of the right size on the tape. */
+    template<typename Step>
+    std::vector<Variable<Scalar>> call(Step &step, Tape<Scalar> &tape, const std::vector<Variable<Scalar>> &parameters, const std::vector<Variable<Scalar>> &state, size_t index) {
+      count++;
+      std::vector<Variable<Scalar>> next = step(tape, std::span<const Variable<Scalar>>(parameters), std::span<const Variable<Scalar>>(state), index);
+      if (next.size() != state.size()) {
+        throw std::invalid_argument("Step of an `AutoGrad::rollout()` changed the size of the state");
+      }
+      for (const Variable<Scalar> &variable : next) {
+        if (&variable.tape != &tape) {
+          throw std::invalid_argument("`AutoGrad::Variable` not from the `AutoGrad::Tape` of the `AutoGrad::rollout()`");
+        }
+        tape.validate(variable);
+      }
+      return next;
+    }
+
+    /* Compute the state after the steps in `[begin, end)` from the state before them without recording anything. */
+    template<typename Step>
+    std::vector<Scalar> advance(Step &step, Tape<Scalar> &tape, std::span<const Scalar> parameters, std::vector<Scalar> state, size_t begin, size_t end) {
+      if (begin == end) {
+        return state;
+      }
+      tape.clear();
+      NoGradScope<Scalar> scope(tape);
+      std::vector<Variable<Scalar>> constants = leaves(tape, parameters);
+      std::vector<Variable<Scalar>> variables = leaves(tape, state);
+      for (size_t index = begin; index < end; index++) {
+        variables = call(step, tape, constants, variables, index);
+      }
+      for (size_t element = 0; element < state.size(); element++) {
+        state[element] = variables[element].val;
+      }
+      return state;
+    }
+
+    /* Record the given variables on the tape, seed the adjoints of the given outputs (constant outputs have none) and
+    sweep the tape backwards, accumulating the adjoints of the parameters and replacing the given adjoints with those of
+    the state. */
+    void propagate(Tape<Scalar> &tape, const std::vector<Variable<Scalar>> &parameters, const std::vector<Variable<Scalar>> &state, std::span<const Variable<Scalar>> outputs, std::vector<Scalar> &adjoints) {
+      std::vector<Scalar> buffer(tape.size(), 0.0);
+      Index start = 0;
+      bool seeded = false;
+      for (size_t output = 0; output < outputs.size(); output++) {
+        if (outputs[output].index != Tape<Scalar>::passive) {
+          buffer[outputs[output].index] += adjoints[output];
+          start = std::max(start, outputs[output].index);
+          seeded = true;
+        }
+      }
+      if (seeded) {
+        tape.sweep(buffer, start);
+      }
+      for (size_t parameter = 0; parameter < parameters.size(); parameter++) {
+        parameterAdjoints[parameter] += buffer[parameters[parameter].index];
+      }
+      adjoints.resize(state.size());
+      for (size_t element = 0; element < state.size(); element++) {
+        adjoints[element] = buffer[state[element].index];
+      }
+    }
+
+    /* Reverse the steps in `[begin, end)` given the state before them, replacing the given adjoints of the state after
+    them with those of the state before them. States are stored at most at the given number of intermediate steps at a
+    time: the range is split so that its latter part can be reversed with one checkpoint fewer (storing the state at the
+    split point) and its former part with the same number (once the latter part is done and its state released). The
+    split is chosen by the binomial rule of Griewank's revolve, which minimizes the number of evaluations of the steps.
+    The states at the first split points, if stored by the forward pass (see `splits()`), are not computed again. */
+    template<typename Step>
+    void reverse(Step &step, Tape<Scalar> &tape, std::span<const Scalar> parameters, const std::vector<Scalar> &state, size_t begin, size_t end, std::vector<Scalar> &adjoints, size_t checkpoints, std::span<std::vector<Scalar>> stored) {
+      while (end - begin > 1) {
+        size_t latter = split(end - begin, checkpoints);
+        std::vector<Scalar> middle;
+        if (stored.empty()) {
+          middle = advance(step, tape, parameters, state, begin, end - latter);
+        } else {
+          middle = std::move(stored.front());
+          stored = stored.subspan(1);
+        }
+        reverse(step, tape, parameters, middle, end - latter, end, adjoints, checkpoints - (checkpoints > 0), std::exchange(stored, {}));
+        end -= latter;
+      }
+      tape.clear();
+      std::vector<Variable<Scalar>> constants = leaves(tape, parameters);
+      std::vector<Variable<Scalar>> variables = leaves(tape, state);
+      std::vector<Variable<Scalar>> next = call(step, tape, constants, variables, begin);
+      propagate(tape, constants, variables, next, adjoints);
+    }
+
+    /* Compute the value of the loss at the end of the rollout from its final state, and then its gradient by reversing
+    the steps from the last to the first. As in revolve, the forward pass stores the states at which the reversal first
+    splits each range, so that they are not computed a second time. */
+    template<typename Step, typename Loss>
+    void compute(Step &step, Loss &loss, std::span<const Scalar> parameters, std::span<const Scalar> state, size_t steps, size_t checkpoints) {
+      Tape<Scalar> tape;
+      std::vector<Scalar> initial(state.begin(), state.end());
+      std::vector<std::vector<Scalar>> stored;
+      std::vector<Scalar> last = initial;
+      size_t position = 0;
+      for (size_t point : splits(steps, checkpoints)) {
+        last = advance(step, tape, parameters, std::move(last), position, point);
+        stored.push_back(last);
+        position = point;
+      }
+      last = advance(step, tape, parameters, std::move(last), position, steps);
+      tape.clear();
+      std::vector<Variable<Scalar>> constants = leaves(tape, parameters);
+      std::vector<Variable<Scalar>> variables = leaves(tape, last);
+      Variable<Scalar> output = loss(tape, std::span<const Variable<Scalar>>(constants), std::span<const Variable<Scalar>>(variables));
+      if (&output.tape != &tape) {
+        throw std::invalid_argument("`AutoGrad::Variable` not from the `AutoGrad::Tape` of the `AutoGrad::rollout()`");
+      }
+      tape.validate(output);
+      val = output.val;
+      std::vector<Scalar> adjoints = {1.0};
+      propagate(tape, constants, variables, std::span<const Variable<Scalar>>(&output, 1), adjoints);
+      if (steps > 0) {
+        reverse(step, tape, parameters, initial, 0, steps, adjoints, checkpoints, std::span<std::vector<Scalar>>(stored));
+      }
+      stateAdjoints = std::move(adjoints);
+    }
+
+    /* Retrieve the number of steps at the end of a range of the given number of steps that are reversed first with one
+    checkpoint fewer, by the binomial rule of revolve. */
+    static size_t split(size_t steps, size_t checkpoints) {
+      if (checkpoints == 0) {
+        return 1;
+      }
+      // Find the least number of repetitions with which the range can be reversed (counting the state before it as a
+      // checkpoint), at which the latter part can have up to `binomial(checkpoints, repetitions)` steps.
+      size_t repetitions = 0;
+      while (binomial(checkpoints + 1, repetitions) < steps) {
+        repetitions++;
+      }
+      return std::min(binomial(checkpoints, repetitions), steps - 1);
+    }
+
+    /* Retrieve the steps at which `reverse()` first splits the whole rollout and then each latter part while it has
+    checkpoints left, in increasing order, which are the states that it needs first (and all at once). There are at most
+    `checkpoints` of them: once none are left, the state to step from is computed rather than stored. */
+    static std::vector<size_t> splits(size_t steps, size_t checkpoints) {
+      std::vector<size_t> points;
+      for (size_t begin = 0; checkpoints > 0 && steps - begin > 1; checkpoints--) {
+        begin = steps - split(steps - begin, checkpoints);
+        points.push_back(begin);
+      }
+      return points;
+    }
+
+    /* Compute the binomial coefficient `(s + t)! / (s! t!)`, i.e. the number of steps that can be reversed with `s`
+    checkpoints and `t` repetitions (saturating instead of overflowing). */
+    static size_t binomial(size_t s, size_t t) {
+      size_t result = 1;
+      for (size_t k = 1; k <= std::min(s, t); k++) {
+        size_t numerator = std::max(s, t) + k;
+        if (result > std::numeric_limits<size_t>::max() / numerator) {
+          return std::numeric_limits<size_t>::max();
+        }
+        result = result * numerator / k;
+      }
+      return result;
+    }
+  };
+
+  /* Compute the value and gradient of a loss at the end of a rollout of the given number of steps from the given
+  initial state, keeping at most `checkpoints` intermediate states in memory (besides the state that the step being
+  recorded starts from) and recording a single step at a time, so that the memory used does not grow with the number of
+  steps (e.g. for an ODE integrated over millions of steps, where recording the whole rollout would exceed the available
+  memory). Steps are recomputed from the stored states as needed instead, which with `c` checkpoints takes about `t + 1`
+  evaluations per step for the least `t` such that `binomial(c + 1 + t, t)` is at least the number of steps (e.g. 4 for
+  a million steps and 200 checkpoints), counting the forward pass that computes the final state (and stores the first
+  checkpoints on the way).
+
+  Each step is called as `step(tape, parameters, state, index)`, where `parameters` and `state` are of type
+  `std::span<const Variable<Scalar>>` and `index` is the index of the step, and must return a
+  `std::vector<Variable<Scalar>>` with the next state (on `tape`). A step can be any number of time steps of the
+  simulation: the states between steps are the only ones that can be checkpointed. The loss is called as
+  `loss(tape, parameters, state)` with the final state and must return a variable on `tape`. Both may be called several
+  times at the same index and must give the same result each time. */
+  template<FloatingPoint Scalar, typename Step, typename Loss>
+  Rollout<Scalar> rollout(Step step, Loss loss, std::span<const Scalar> parameters, std::span<const Scalar> state, size_t steps, size_t checkpoints) {
+    Rollout<Scalar> rollout_(parameters.size(), state.size());
+    rollout_.compute(step, loss, parameters, state, steps, checkpoints);
+    return rollout_;
+  }
+}
+
+
+#endif // AUTOGRAD_CHECKPOINT_HPP
@@ -0,0 +1,65 @@
+#ifndef AUTOGRAD_CONSTANT_HPP
+#define AUTOGRAD_CONSTANT_HPP
+
+
+#include "utils.hpp"
+
+namespace AutoGrad {
+
+  /* A floating-point value that is known at compile time never to need a gradient, e.g. a physical constant or a
+  hyperparameter of a model. It converts to its scalar, so operations between a variable and a constant resolve to the
+  overloads for scalars when they are compiled: they record a single node with a single edge, or nothing at all when
+  the variable is itself a constant (see `Tape::constant()`). Operations between constants only compute values. */
+  template<FloatingPoint Scalar>
+  class Constant {
+  public:
+    /* Construct a new constant object with the given value. */
+    constexpr explicit Constant(Scalar value_) noexcept : val{value_} {} // Constructor
+
+    /* Convert the constant to its value. */
+    constexpr operator Scalar() const noexcept {
+      return val;
+    }
+
+    /* Retrieve the actual numerical value. */
+    constexpr Scalar value() const noexcept {
+      return val;
+    }
+
+    /* Identity. */
+    constexpr Constant<Scalar> operator+() const noexcept {
+      return *this;
+    }
+
+    /* Negation. */
+    constexpr Constant<Scalar> operator-() const noexcept {
+      return Constant<Scalar>(-val);
+    }
+
+    /* Addition. */
+    friend constexpr Constant<Scalar> operator+(const Constant<Scalar> &constant1, const Constant<Scalar> &constant2) noexcept {
+      return Constant<Scalar>(constant1.val + constant2.val);
+    }
+
+    /* Subtraction. */
+    friend constexpr Constant<Scalar> operator-(const Constant<Scalar> &constant1, const Constant<Scalar> &constant2) noexcept {
+      return Constant<Scalar>(constant1.val - constant2.val);
+    }
+
+    /* Multiplication. */
+    friend constexpr Constant<Scalar> operator*(const Constant<Scalar> &constant1, const Constant<Scalar> &constant2) noexcept {
+      return Constant<Scalar>(constant1.val * constant2.val);
+    }
+
+    /* Division. */
+    friend constexpr Constant<Scalar> operator/(const Constant<Scalar> &constant1, const Constant<Scalar> &constant2) noexcept {
+      return Constant<Scalar>(constant1.val / constant2.val);
+    }
+
+  private:
+    Scalar val; // Numerical value.
+  };
+}
+
+
+#endif // AUTOGRAD_CONSTANT_HPP
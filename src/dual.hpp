@@ -0,0 +1,653 @@
+
+#ifndef AUTOGRAD_DUAL_HPP
+#define AUTOGRAD_DUAL_HPP
+
+
+#include "operations.hpp"
+#include "utils.hpp"
+
+namespace AutoGrad {
+
+  /* A floating-point dual number type for forward-mode automatic differentiation: a value together with its directional
+  derivatives along `N` seed directions (e.g. with respect to `N` input variables). The derivatives are computed
+  alongside the value, so no tape is recorded and no memory is allocated, which makes it preferable to `Variable` for
+  functions with few inputs and many outputs. The derivatives are stored inline and every operation on them is a loop
+  of fixed length `N` that the compiler can vectorize. */
+  template<FloatingPoint Scalar, size_t N = 1>
+  class Dual {
+
+    // Arithmetic and comparison operators are defined as (non-template) friends so that they are found through
+    // argument-dependent lookup and scalars are implicitly converted to constant dual numbers, which allows the
+    // differentiation rules in `AutoGrad::Operations` to be applied to dual numbers as well.
+
+    // Arithmetic operations
+
+    /* Addition. */
+    friend Dual operator+(const Dual &dual1, const Dual &dual2) {
+      return apply<Operations::Addition>(dual1, dual2);
+    }
+
+    /* Addition. */
+    friend Dual operator+(const Dual &dual, Scalar scalar) {
+      return apply<Operations::Addition>(dual, scalar);
+    }
+
+    /* Addition. */
+    friend Dual operator+(Scalar scalar, const Dual &dual) {
+      return dual + scalar;
+    }
+
+    /* Subtraction. */
+    friend Dual operator-(const Dual &dual1, const Dual &dual2) {
+      return apply<Operations::Subtraction>(dual1, dual2);
+    }
+
+    /* Subtraction. */
+    friend Dual operator-(const Dual &dual, Scalar scalar) {
+      return apply<Operations::Subtraction>(dual, scalar);
+    }
+
+    /* Subtraction. */
+    friend Dual operator-(Scalar scalar, const Dual &dual) {
+      return apply<Operations::Subtraction>(scalar, dual);
+    }
+
+    /* Multiplication. */
+    friend Dual operator*(const Dual &dual1, const Dual &dual2) {
+      return apply<Operations::Multiplication>(dual1, dual2);
+    }
+
+    /* Multiplication. */
+    friend Dual operator*(const Dual &dual, Scalar scalar) {
+      return apply<Operations::Multiplication>(dual, scalar);
+    }
+
+    /* Multiplication. */
+    friend Dual operator*(Scalar scalar, const Dual &dual) {
+      return dual * scalar;
+    }
+
+    /* Division. */
+    friend Dual operator/(const Dual &dual1, const Dual &dual2) {
+      return apply<Operations::Division>(dual1, dual2);
+    }
+
+    /* Division. */
+    friend Dual operator/(const Dual &dual, Scalar scalar) {
+      return apply<Operations::Division>(dual, scalar);
+    }
+
+    /* Division. */
+    friend Dual operator/(Scalar scalar, const Dual &dual) {
+      return apply<Operations::Division>(scalar, dual);
+    }
+
+    // Comparison operators
+
+    /* Equality.
+    NOTE: this directly compares two floating-point values using `==` and is therefore unsafe. */
+    friend bool operator==(const Dual &dual1, const Dual &dual2) {
+      return dual1.val == dual2.val;
+    }
+
+    /* Inequality.
+    NOTE: this directly compares two floating-point values using `!=` and is therefore unsafe. */
+    friend bool operator!=(const Dual &dual1, const Dual &dual2) {
+      return dual1.val != dual2.val;
+    }
+
+    /* Greater than. */
+    friend bool operator>(const Dual &dual1, const Dual &dual2) {
+      return dual1.val > dual2.val;
+    }
+
+    /* Less than. */
+    friend bool operator<(const Dual &dual1, const Dual &dual2) {
+      return dual1.val < dual2.val;
+    }
+
+    /* Greater than or equal to. */
+    friend bool operator>=(const Dual &dual1, const Dual &dual2) {
+      return dual1.val >= dual2.val;
+    }
+
+    /* Less than or equal to. */
+    friend bool operator<=(const Dual &dual1, const Dual &dual2) {
+      return dual1.val <= dual2.val;
+    }
+
+    // The elementary mathematical functions are function templates (like those for `Variable`) that have to be declared
+    // as friends so that they can access private members and methods.
+
+    // Exponentiation and logarithmic functions
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> pow(const Dual<S, M> &dual1, const Dual<S, M> &dual2);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> pow(const Dual<S, M> &dual, S scalar);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> pow(S scalar, const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> sqrt(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> cbrt(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> exp(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> exp2(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> log(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> log(const Dual<S, M> &dual, const Dual<S, M> &base);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> log(const Dual<S, M> &dual, S base);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> log(S scalar, const Dual<S, M> &base);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> ln(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> log2(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> log10(const Dual<S, M> &dual);
+
+    // Trigonometric functions
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> sin(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> cos(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> tan(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> sec(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> csc(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> cot(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arcsin(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arccos(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arctan(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arcsec(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arccsc(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arccot(const Dual<S, M> &dual);
+
+    // Hyperbolic trigonometric functions
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> sinh(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> cosh(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> tanh(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> sech(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> csch(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> coth(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arsinh(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arcosh(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> artanh(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arsech(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arcsch(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> arcoth(const Dual<S, M> &dual);
+
+    template<FloatingPoint S, size_t M>
+    friend Dual<S, M> abs(const Dual<S, M> &dual);
+
+  public:
+    /* Construct a new dual number with a value of zero. */
+    Dual() noexcept = default; // Default constructor
+
+    /* Construct a new constant dual number (one whose derivatives are all zero) from a scalar. */
+    Dual(Scalar value_) noexcept : val{value_} {} // Constructor
+
+    /* Construct a new dual number that represents an input variable: its derivative along the given seed direction is
+    one and all others are zero. */
+    Dual(Scalar value_, size_t direction) : val{value_} { // Constructor
+      if (direction >= N) {
+        throw std::out_of_range("Seed direction out of range for `AutoGrad::Dual`");
+      }
+      derivatives[direction] = 1.0;
+    }
+
+    /* Construct a new dual number given a value and its derivatives along each seed direction. */
+    Dual(Scalar value_, const std::array<Scalar, N> &derivatives_) noexcept : val{value_}, derivatives(derivatives_) {} // Constructor
+
+    // Assignment operators
+
+    /* Addition assignment. */
+    Dual<Scalar, N> &operator+=(const Dual<Scalar, N> &dual) {
+      *this = *this + dual;
+      return *this;
+    }
+
+    /* Subtraction assignment. */
+    Dual<Scalar, N> &operator-=(const Dual<Scalar, N> &dual) {
+      *this = *this - dual;
+      return *this;
+    }
+
+    /* Multiplication assignment. */
+    Dual<Scalar, N> &operator*=(const Dual<Scalar, N> &dual) {
+      *this = *this * dual;
+      return *this;
+    }
+
+    /* Division assignment. */
+    Dual<Scalar, N> &operator/=(const Dual<Scalar, N> &dual) {
+      *this = *this / dual;
+      return *this;
+    }
+
+    /* Identity. */
+    Dual<Scalar, N> operator+() const {
+      return *this;
+    }
+
+    /* Negation. */
+    Dual<Scalar, N> operator-() const {
+      Dual<Scalar, N> result(-val);
+      for (size_t direction = 0; direction < N; direction++) {
+        result.derivatives[direction] = -derivatives[direction];
+      }
+      return result;
+    }
+
+    /* Retrive the actual numerical value. */
+    Scalar value() const noexcept {
+      return val;
+    }
+
+    /* Retrieve the derivative along the given seed direction (i.e. the partial derivative with respect to the input
+    variable seeded with that direction). */
+    Scalar derivative(size_t direction) const {
+      if (direction >= N) {
+        throw std::out_of_range("Seed direction out of range for `AutoGrad::Dual`");
+      }
+      return derivatives[direction];
+    }
+
+  private:
+    Scalar val = 0.0; // Actual numerical value.
+    std::array<Scalar, N> derivatives{}; // Derivatives along each seed direction.
+
+    /* Apply a unary operation (see `AutoGrad::Operations`) to a dual number using the chain rule. */
+    template<typename Operation>
+    static Dual<Scalar, N> apply(const Dual<Scalar, N> &dual) {
+      auto [value, derivative] = Operations::evaluate<Operation>(dual.val);
+      Dual<Scalar, N> result(value);
+      for (size_t direction = 0; direction < N; direction++) {
+        result.derivatives[direction] = derivative * dual.derivatives[direction];
+      }
+      return result;
+    }
+
+    /* Apply a binary operation (see `AutoGrad::Operations`) to two dual numbers using the chain rule. */
+    template<typename Operation>
+    static Dual<Scalar, N> apply(const Dual<Scalar, N> &dual1, const Dual<Scalar, N> &dual2) {
+      Dual<Scalar, N> result(Operation::value(dual1.val, dual2.val));
+      Scalar left = Operation::left(dual1.val, dual2.val, result.val);
+      Scalar right = Operation::right(dual1.val, dual2.val, result.val);
+      for (size_t direction = 0; direction < N; direction++) {
+        result.derivatives[direction] = left * dual1.derivatives[direction] + right * dual2.derivatives[direction];
+      }
+      return result;
+    }
+
+    /* Apply a binary operation (see `AutoGrad::Operations`) to a dual number and a scalar using the chain rule. */
+    template<typename Operation>
+    static Dual<Scalar, N> apply(const Dual<Scalar, N> &dual, Scalar scalar) {
+      Dual<Scalar, N> result(Operation::value(dual.val, scalar));
+      Scalar left = Operation::left(dual.val, scalar, result.val);
+      for (size_t direction = 0; direction < N; direction++) {
+        result.derivatives[direction] = left * dual.derivatives[direction];
+      }
+      return result;
+    }
+
+    /* Apply a binary operation (see `AutoGrad::Operations`) to a scalar and a dual number using the chain rule. */
+    template<typename Operation>
+    static Dual<Scalar, N> apply(Scalar scalar, const Dual<Scalar, N> &dual) {
+      Dual<Scalar, N> result(Operation::value(scalar, dual.val));
+      Scalar right = Operation::right(scalar, dual.val, result.val);
+      for (size_t direction = 0; direction < N; direction++) {
+        result.derivatives[direction] = right * dual.derivatives[direction];
+      }
+      return result;
+    }
+  };
+
+  // Exponentiation and logarithmic functions
+
+  /* Exponentiation (powers). */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> pow(const Dual<S, N> &dual1, const Dual<S, N> &dual2) {
+    return Dual<S, N>::template apply<Operations::Power>(dual1, dual2);
+  }
+
+  /* Exponentiation (powers). */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> pow(const Dual<S, N> &dual, S scalar) {
+    return Dual<S, N>::template apply<Operations::Power>(dual, scalar);
+  }
+
+  /* Exponentiation (powers). */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> pow(S scalar, const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::Power>(scalar, dual);
+  }
+
+  /* Square root. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> sqrt(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::SquareRoot>(dual);
+  }
+
+  /* Cube root. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> cbrt(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::CubeRoot>(dual);
+  }
+
+  /* Exponential function. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> exp(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::Exponential>(dual);
+  }
+
+  /* Base-2 exponential function. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> exp2(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::BinaryExponential>(dual);
+  }
+
+  /* Natural logarithm. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> log(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::NaturalLogarithm>(dual);
+  }
+
+  /* Logarithm with a specified base. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> log(const Dual<S, N> &dual, const Dual<S, N> &base) {
+    return Dual<S, N>::template apply<Operations::Logarithm>(dual, base);
+  }
+
+  /* Logarithm with a specified base. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> log(const Dual<S, N> &dual, S base) {
+    return Dual<S, N>::template apply<Operations::Logarithm>(dual, base);
+  }
+
+  /* Logarithm with a specified base. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> log(S scalar, const Dual<S, N> &base) {
+    return Dual<S, N>::template apply<Operations::Logarithm>(scalar, base);
+  }
+
+  /* Natural logarithm. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> ln(const Dual<S, N> &dual) {
+    return log(dual);
+  }
+
+  /* Base-2 logarithm. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> log2(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::BinaryLogarithm>(dual);
+  }
+
+  /* Base-10 logarithm. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> log10(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::CommonLogarithm>(dual);
+  }
+
+  // Trigonometric functions
+
+  /* Sine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> sin(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::Sine>(dual);
+  }
+
+  /* Cosine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> cos(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::Cosine>(dual);
+  }
+
+  /* Tangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> tan(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::Tangent>(dual);
+  }
+
+  /* Secant. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> sec(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::Secant>(dual);
+  }
+
+  /* Cosecant. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> csc(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::Cosecant>(dual);
+  }
+
+  /* Cotangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> cot(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::Cotangent>(dual);
+  }
+
+  /* Inverse sine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arcsin(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseSine>(dual);
+  }
+
+  /* Inverse cosine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arccos(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseCosine>(dual);
+  }
+
+  /* Inverse tangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arctan(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseTangent>(dual);
+  }
+
+  /* Inverse secant. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arcsec(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseSecant>(dual);
+  }
+
+  /* Inverse cosecant. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arccsc(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseCosecant>(dual);
+  }
+
+  /* Inverse cotangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arccot(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseCotangent>(dual);
+  }
+
+  // Hyperbolic trigonometric functions
+
+  /* Hyperbolic sine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> sinh(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::HyperbolicSine>(dual);
+  }
+
+  /* Hyperbolic cosine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> cosh(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::HyperbolicCosine>(dual);
+  }
+
+  /* Hyperbolic tangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> tanh(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::HyperbolicTangent>(dual);
+  }
+
+  /* Hyperbolic secant. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> sech(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::HyperbolicSecant>(dual);
+  }
+
+  /* Hyperbolic cosecant. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> csch(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::HyperbolicCosecant>(dual);
+  }
+
+  /* Hyperbolic cotangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> coth(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::HyperbolicCotangent>(dual);
+  }
+
+  /* Inverse hyperbolic sine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arsinh(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseHyperbolicSine>(dual);
+  }
+
+  /* Inverse hyperbolic cosine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arcosh(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseHyperbolicCosine>(dual);
+  }
+
+  /* Inverse hyperbolic tangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> artanh(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseHyperbolicTangent>(dual);
+  }
+
+  /* Inverse hyperbolic secant. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arsech(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseHyperbolicSecant>(dual);
+  }
+
+  /* Inverse hyperbolic cosecant. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arcsch(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseHyperbolicCosecant>(dual);
+  }
+
+  /* Inverse hyperbolic cotangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> arcoth(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::InverseHyperbolicCotangent>(dual);
+  }
+
+  /* Absolute value. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> abs(const Dual<S, N> &dual) {
+    return Dual<S, N>::template apply<Operations::AbsoluteValue>(dual);
+  }
+
+  // Inverse trigonometric and hyperbolic functions under their names in the standard library, which the rules in
+  // `AutoGrad::Operations` call so that they can be applied to dual numbers (e.g. when recording them on a tape).
+
+  /* Inverse sine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> asin(const Dual<S, N> &dual) {
+    return arcsin(dual);
+  }
+
+  /* Inverse cosine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> acos(const Dual<S, N> &dual) {
+    return arccos(dual);
+  }
+
+  /* Inverse tangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> atan(const Dual<S, N> &dual) {
+    return arctan(dual);
+  }
+
+  /* Inverse hyperbolic sine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> asinh(const Dual<S, N> &dual) {
+    return arsinh(dual);
+  }
+
+  /* Inverse hyperbolic cosine. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> acosh(const Dual<S, N> &dual) {
+    return arcosh(dual);
+  }
+
+  /* Inverse hyperbolic tangent. */
+  template<FloatingPoint S, size_t N>
+  Dual<S, N> atanh(const Dual<S, N> &dual) {
+    return artanh(dual);
+  }
+
+  /* Dual numbers count as floating-point types (see `AutoGrad::FloatingPoint`). */
+  template<FloatingPoint S, size_t N>
+  struct IsDual<Dual<S, N>> : std::true_type {};
+}
+
+
+#endif // AUTOGRAD_DUAL_HPP
@@ -0,0 +1,541 @@
+
+#ifndef AUTOGRAD_EXPRESSION_HPP
+#define AUTOGRAD_EXPRESSION_HPP
+
+
+#include "operations.hpp"
+#include "tape.hpp"
+#include "utils.hpp"
+#include "variable.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class Variable; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Tape; // Forward declaration
+
+  // Fused expressions are expression templates: applying arithmetic operations and elementary mathematical functions to
+  // them (or to them and variables) does not record anything but instead builds a tree of operations whose type is
+  // known at compile time. Converting the tree to a `Variable` evaluates the partial derivatives of the whole expression
+  // with respect to the variables in it and records them as the edges of a single node, rather than one node per
+  // operation. The values are computed eagerly as the tree is built, and the variables and constants in it are stored
+  // by value, so an expression can safely outlive the variables it was built from.
+
+  /* Accumulates the partial derivatives of a fused expression with respect to the variables in it (merging repeated
+  occurrences of the same variable) so that they can be recorded as the edges of a single node. Note that this class is
+  only for internal use. */
+  template<FloatingPoint Scalar, size_t Capacity>
+  class Partials {
+    friend class Tape<Scalar>;
+    friend class Variable<Scalar>;
+
+  public:
+
+    /* Add the partial derivative with respect to the variable with the given index (unless it is a constant). */
+    void add(Tape<Scalar> &tape_, Scalar weight, Index dependency) {
+      if (tape == nullptr) {
+        tape = &tape_;
+      } else if (tape != &tape_) {
+        throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
+      }
+      if (dependency == Tape<Scalar>::passive) {
+        return;
+      }
+      for (size_t edge = 0; edge < edges; edge++) {
+        if (dependencies[edge] == dependency) {
+          weights[edge] += weight;
+          return;
+        }
+      }
+      weights[edges] = weight;
+      dependencies[edges] = dependency;
+      edges++;
+    }
+
+  private:
+    Tape<Scalar> *tape = nullptr; // Tape that the variables in the expression were created on.
+    size_t edges = 0; // Number of distinct variables in the expression.
+    std::array<Scalar, Capacity> weights; // Partial derivative with respect to each distinct variable.
+    std::array<Index, Capacity> dependencies; // Index of each distinct variable.
+
+    /* Compute the partial derivatives of the given expression. */
+    template<Expression E>
+    explicit Partials(const E &expression) { // Constructor
+      expression.propagate(1.0, *this);
+    }
+  };
+
+  /* A variable in a fused expression. */
+  template<FloatingPoint S>
+  class LeafExpression {
+    template<FloatingPoint T>
+    friend LeafExpression<T> fuse(const Variable<T> &variable);
+
+  public:
+    using Scalar = S;
+
+    static constexpr size_t leaves = 1; // Number of variables in the expression.
+
+    /* Retrive the actual numerical value. */
+    Scalar value() const noexcept {
+      return val;
+    }
+
+    /* Accumulate the partial derivative of the enclosing expression with respect to the variable. */
+    template<size_t Capacity>
+    void propagate(Scalar adjoint, Partials<Scalar, Capacity> &partials) const {
+      partials.add(*tape, adjoint, index);
+    }
+
+  private:
+    Tape<Scalar> *tape; // Tape that the variable was created on.
+    Scalar val; // Actual numerical value.
+    Index index; // Index of the variable in the computational graph held by the tape.
+
+    /* Construct a leaf of an expression given the tape, value, and index of a variable. */
+    LeafExpression(Tape<Scalar> &tape_, Scalar value_, Index index_) noexcept : tape{&tape_}, val{value_}, index{index_} {} // Constructor
+  };
+
+  /* A constant (scalar) in a fused expression. */
+  template<FloatingPoint S>
+  class ConstantExpression {
+  public:
+    using Scalar = S;
+
+    static constexpr size_t leaves = 0; // Number of variables in the expression.
+
+    /* Construct a constant in an expression. */
+    explicit ConstantExpression(Scalar value_) noexcept : val{value_} {} // Constructor
+
+    /* Retrive the actual numerical value. */
+    Scalar value() const noexcept {
+      return val;
+    }
+
+    /* Accumulate nothing, since a constant has no partial derivatives. */
+    template<size_t Capacity>
+    void propagate(Scalar, Partials<Scalar, Capacity> &) const {}
+
+  private:
+    Scalar val; // Actual numerical value.
+  };
+
+  /* A unary operation (see `AutoGrad::Operations`) applied to a fused expression. */
+  template<typename Operation, Expression Argument>
+  class UnaryExpression {
+  public:
+    using Scalar = typename Argument::Scalar;
+
+    static constexpr size_t leaves = Argument::leaves; // Number of variables in the expression.
+
+    /* Construct an expression by applying the operation to the given argument. */
+    explicit UnaryExpression(const Argument &argument_) : argument(argument_), val{Operation::value(argument_.value())} {} // Constructor
+
+    /* Retrive the actual numerical value. */
+    Scalar value() const noexcept {
+      return val;
+    }
+
+    /* Accumulate the partial derivatives of the enclosing expression with respect to the variables in the argument. */
+    template<size_t Capacity>
+    void propagate(Scalar adjoint, Partials<Scalar, Capacity> &partials) const {
+      argument.propagate(adjoint * Operation::derivative(argument.value(), val), partials);
+    }
+
+  private:
+    Argument argument; // Operand of the operation.
+    Scalar val; // Actual numerical value.
+  };
+
+  /* A binary operation (see `AutoGrad::Operations`) applied to two fused expressions. */
+  template<typename Operation, Expression Left, Expression Right>
+    requires std::same_as<typename Left::Scalar, typename Right::Scalar>
+  class BinaryExpression {
+  public:
+    using Scalar = typename Left::Scalar;
+
+    static constexpr size_t leaves = Left::leaves + Right::leaves; // Number of variables in the expression.
+
+    /* Construct an expression by applying the operation to the given arguments. */
+    BinaryExpression(const Left &left_, const Right &right_) : left(left_), right(right_), val{Operation::value(left_.value(), right_.value())} {} // Constructor
+
+    /* Retrive the actual numerical value. */
+    Scalar value() const noexcept {
+      return val;
+    }
+
+    /* Accumulate the partial derivatives of the enclosing expression with respect to the variables in the arguments.
+    The partial derivative with respect to an argument without variables (a constant) is never evaluated. */
+    template<size_t Capacity>
+    void propagate(Scalar adjoint, Partials<Scalar, Capacity> &partials) const {
+      if constexpr (Left::leaves > 0) {
+        left.propagate(adjoint * Operation::left(left.value(), right.value(), val), partials);
+      }
+      if constexpr (Right::leaves > 0) {
+        right.propagate(adjoint * Operation::right(left.value(), right.value(), val), partials);
+      }
+    }
+
+  private:
+    Left left; // First operand of the operation.
+    Right right; // Second operand of the operation.
+    Scalar val; // Actual numerical value.
+  };
+
+  /* Start a fused expression from a variable. Operations on the result build an expression that is recorded as a
+  single node once it is converted back to a `Variable`, for example:
+  `AutoGrad::Variable<double> z = AutoGrad::fuse(x) * y + AutoGrad::sin(AutoGrad::fuse(x));` */
+  template<FloatingPoint S>
+  LeafExpression<S> fuse(const Variable<S> &variable) {
+    variable.tape.validate(variable);
+    return LeafExpression<S>(variable.tape, variable.val, variable.index);
+  }
+
+  /* Start a fused expression from an expression (i.e. leave it as is). */
+  template<Expression E>
+  E fuse(const E &expression) {
+    return expression;
+  }
+
+  /* The fused expression that an operand (a variable or an expression) is converted to. */
+  template<typename T>
+  using Fused = decltype(fuse(std::declval<const T &>()));
+
+  /* Determines if two operands can be combined into a fused expression: both are variables or expressions, and at
+  least one of them is an expression (operations on two variables are recorded as usual). */
+  template<typename T1, typename T2>
+  concept Fusible = (Expression<T1> || Expression<T2>) && requires(const T1 &operand1, const T2 &operand2) {
+    fuse(operand1);
+    fuse(operand2);
+  };
+
+  // Arithmetic operations
+
+  /* Addition. */
+  template<typename T1, typename T2> requires Fusible<T1, T2>
+  BinaryExpression<Operations::Addition, Fused<T1>, Fused<T2>> operator+(const T1 &operand1, const T2 &operand2) {
+    return BinaryExpression<Operations::Addition, Fused<T1>, Fused<T2>>(fuse(operand1), fuse(operand2));
+  }
+
+  /* Addition. */
+  template<Expression E>
+  BinaryExpression<Operations::Addition, E, ConstantExpression<typename E::Scalar>> operator+(const E &expression, typename E::Scalar scalar) {
+    return BinaryExpression<Operations::Addition, E, ConstantExpression<typename E::Scalar>>(expression, ConstantExpression<typename E::Scalar>(scalar));
+  }
+
+  /* Addition. */
+  template<Expression E>
+  BinaryExpression<Operations::Addition, ConstantExpression<typename E::Scalar>, E> operator+(typename E::Scalar scalar, const E &expression) {
+    return BinaryExpression<Operations::Addition, ConstantExpression<typename E::Scalar>, E>(ConstantExpression<typename E::Scalar>(scalar), expression);
+  }
+
+  /* Subtraction. */
+  template<typename T1, typename T2> requires Fusible<T1, T2>
+  BinaryExpression<Operations::Subtraction, Fused<T1>, Fused<T2>> operator-(const T1 &operand1, const T2 &operand2) {
+    return BinaryExpression<Operations::Subtraction, Fused<T1>, Fused<T2>>(fuse(operand1), fuse(operand2));
+  }
+
+  /* Subtraction. */
+  template<Expression E>
+  BinaryExpression<Operations::Subtraction, E, ConstantExpression<typename E::Scalar>> operator-(const E &expression, typename E::Scalar scalar) {
+    return BinaryExpression<Operations::Subtraction, E, ConstantExpression<typename E::Scalar>>(expression, ConstantExpression<typename E::Scalar>(scalar));
+  }
+
+  /* Subtraction. */
+  template<Expression E>
+  BinaryExpression<Operations::Subtraction, ConstantExpression<typename E::Scalar>, E> operator-(typename E::Scalar scalar, const E &expression) {
+    return BinaryExpression<Operations::Subtraction, ConstantExpression<typename E::Scalar>, E>(ConstantExpression<typename E::Scalar>(scalar), expression);
+  }
+
+  /* Multiplication. */
+  template<typename T1, typename T2> requires Fusible<T1, T2>
+  BinaryExpression<Operations::Multiplication, Fused<T1>, Fused<T2>> operator*(const T1 &operand1, const T2 &operand2) {
+    return BinaryExpression<Operations::Multiplication, Fused<T1>, Fused<T2>>(fuse(operand1), fuse(operand2));
+  }
+
+  /* Multiplication. */
+  template<Expression E>
+  BinaryExpression<Operations::Multiplication, E, ConstantExpression<typename E::Scalar>> operator*(const E &expression, typename E::Scalar scalar) {
+    return BinaryExpression<Operations::Multiplication, E, ConstantExpression<typename E::Scalar>>(expression, ConstantExpression<typename E::Scalar>(scalar));
+  }
+
+  /* Multiplication. */
+  template<Expression E>
+  BinaryExpression<Operations::Multiplication, ConstantExpression<typename E::Scalar>, E> operator*(typename E::Scalar scalar, const E &expression) {
+    return BinaryExpression<Operations::Multiplication, ConstantExpression<typename E::Scalar>, E>(ConstantExpression<typename E::Scalar>(scalar), expression);
+  }
+
+  /* Division. */
+  template<typename T1, typename T2> requires Fusible<T1, T2>
+  BinaryExpression<Operations::Division, Fused<T1>, Fused<T2>> operator/(const T1 &operand1, const T2 &operand2) {
+    return BinaryExpression<Operations::Division, Fused<T1>, Fused<T2>>(fuse(operand1), fuse(operand2));
+  }
+
+  /* Division. */
+  template<Expression E>
+  BinaryExpression<Operations::Division, E, ConstantExpression<typename E::Scalar>> operator/(const E &expression, typename E::Scalar scalar) {
+    return BinaryExpression<Operations::Division, E, ConstantExpression<typename E::Scalar>>(expression, ConstantExpression<typename E::Scalar>(scalar));
+  }
+
+  /* Division. */
+  template<Expression E>
+  BinaryExpression<Operations::Division, ConstantExpression<typename E::Scalar>, E> operator/(typename E::Scalar scalar, const E &expression) {
+    return BinaryExpression<Operations::Division, ConstantExpression<typename E::Scalar>, E>(ConstantExpression<typename E::Scalar>(scalar), expression);
+  }
+
+  /* Identity. */
+  template<Expression E>
+  E operator+(const E &expression) {
+    return expression;
+  }
+
+  /* Negation. */
+  template<Expression E>
+  UnaryExpression<Operations::Negation, E> operator-(const E &expression) {
+    return UnaryExpression<Operations::Negation, E>(expression);
+  }
+
+  // Exponentiation and logarithmic functions
+
+  /* Exponentiation (powers). */
+  template<typename T1, typename T2> requires Fusible<T1, T2>
+  BinaryExpression<Operations::Power, Fused<T1>, Fused<T2>> pow(const T1 &operand1, const T2 &operand2) {
+    return BinaryExpression<Operations::Power, Fused<T1>, Fused<T2>>(fuse(operand1), fuse(operand2));
+  }
+
+  /* Exponentiation (powers). */
+  template<Expression E>
+  BinaryExpression<Operations::Power, E, ConstantExpression<typename E::Scalar>> pow(const E &expression, typename E::Scalar scalar) {
+    return BinaryExpression<Operations::Power, E, ConstantExpression<typename E::Scalar>>(expression, ConstantExpression<typename E::Scalar>(scalar));
+  }
+
+  /* Exponentiation (powers). */
+  template<Expression E>
+  BinaryExpression<Operations::Power, ConstantExpression<typename E::Scalar>, E> pow(typename E::Scalar scalar, const E &expression) {
+    return BinaryExpression<Operations::Power, ConstantExpression<typename E::Scalar>, E>(ConstantExpression<typename E::Scalar>(scalar), expression);
+  }
+
+  /* Square root. */
+  template<Expression E>
+  UnaryExpression<Operations::SquareRoot, E> sqrt(const E &expression) {
+    return UnaryExpression<Operations::SquareRoot, E>(expression);
+  }
+
+  /* Cube root. */
+  template<Expression E>
+  UnaryExpression<Operations::CubeRoot, E> cbrt(const E &expression) {
+    return UnaryExpression<Operations::CubeRoot, E>(expression);
+  }
+
+  /* Exponential function. */
+  template<Expression E>
+  UnaryExpression<Operations::Exponential, E> exp(const E &expression) {
+    return UnaryExpression<Operations::Exponential, E>(expression);
+  }
+
+  /* Base-2 exponential function. */
+  template<Expression E>
+  UnaryExpression<Operations::BinaryExponential, E> exp2(const E &expression) {
+    return UnaryExpression<Operations::BinaryExponential, E>(expression);
+  }
+
+  /* Natural logarithm. */
+  template<Expression E>
+  UnaryExpression<Operations::NaturalLogarithm, E> log(const E &expression) {
+    return UnaryExpression<Operations::NaturalLogarithm, E>(expression);
+  }
+
+  /* Logarithm with a specified base. */
+  template<typename T1, typename T2> requires Fusible<T1, T2>
+  BinaryExpression<Operations::Logarithm, Fused<T1>, Fused<T2>> log(const T1 &operand, const T2 &base) {
+    return BinaryExpression<Operations::Logarithm, Fused<T1>, Fused<T2>>(fuse(operand), fuse(base));
+  }
+
+  /* Logarithm with a specified base. */
+  template<Expression E>
+  BinaryExpression<Operations::Logarithm, E, ConstantExpression<typename E::Scalar>> log(const E &expression, typename E::Scalar scalar) {
+    return BinaryExpression<Operations::Logarithm, E, ConstantExpression<typename E::Scalar>>(expression, ConstantExpression<typename E::Scalar>(scalar));
+  }
+
+  /* Logarithm with a specified base. */
+  template<Expression E>
+  BinaryExpression<Operations::Logarithm, ConstantExpression<typename E::Scalar>, E> log(typename E::Scalar scalar, const E &expression) {
+    return BinaryExpression<Operations::Logarithm, ConstantExpression<typename E::Scalar>, E>(ConstantExpression<typename E::Scalar>(scalar), expression);
+  }
+
+  /* Natural logarithm. */
+  template<Expression E>
+  UnaryExpression<Operations::NaturalLogarithm, E> ln(const E &expression) {
+    return log(expression);
+  }
+
+  /* Base-2 logarithm. */
+  template<Expression E>
+  UnaryExpression<Operations::BinaryLogarithm, E> log2(const E &expression) {
+    return UnaryExpression<Operations::BinaryLogarithm, E>(expression);
+  }
+
+  /* Base-10 logarithm. */
+  template<Expression E>
+  UnaryExpression<Operations::CommonLogarithm, E> log10(const E &expression) {
+    return UnaryExpression<Operations::CommonLogarithm, E>(expression);
+  }
+
+  // Trigonometric functions
+
+  /* Sine. */
+  template<Expression E>
+  UnaryExpression<Operations::Sine, E> sin(const E &expression) {
+    return UnaryExpression<Operations::Sine, E>(expression);
+  }
+
+  /* Cosine. */
+  template<Expression E>
+  UnaryExpression<Operations::Cosine, E> cos(const E &expression) {
+    return UnaryExpression<Operations::Cosine, E>(expression);
+  }
+
+  /* Tangent. */
+  template<Expression E>
+  UnaryExpression<Operations::Tangent, E> tan(const E &expression) {
+    return UnaryExpression<Operations::Tangent, E>(expression);
+  }
+
+  /* Secant. */
+  template<Expression E>
+  UnaryExpression<Operations::Secant, E> sec(const E &expression) {
+    return UnaryExpression<Operations::Secant, E>(expression);
+  }
+
+  /* Cosecant. */
+  template<Expression E>
+  UnaryExpression<Operations::Cosecant, E> csc(const E &expression) {
+    return UnaryExpression<Operations::Cosecant, E>(expression);
+  }
+
+  /* Cotangent. */
+  template<Expression E>
+  UnaryExpression<Operations::Cotangent, E> cot(const E &expression) {
+    return UnaryExpression<Operations::Cotangent, E>(expression);
+  }
+
+  /* Inverse sine. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseSine, E> arcsin(const E &expression) {
+    return UnaryExpression<Operations::InverseSine, E>(expression);
+  }
+
+  /* Inverse cosine. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseCosine, E> arccos(const E &expression) {
+    return UnaryExpression<Operations::InverseCosine, E>(expression);
+  }
+
+  /* Inverse tangent. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseTangent, E> arctan(const E &expression) {
+    return UnaryExpression<Operations::InverseTangent, E>(expression);
+  }
+
+  /* Inverse secant. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseSecant, E> arcsec(const E &expression) {
+    return UnaryExpression<Operations::InverseSecant, E>(expression);
+  }
+
+  /* Inverse cosecant. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseCosecant, E> arccsc(const E &expression) {
+    return UnaryExpression<Operations::InverseCosecant, E>(expression);
+  }
+
+  /* Inverse cotangent. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseCotangent, E> arccot(const E &expression) {
+    return UnaryExpression<Operations::InverseCotangent, E>(expression);
+  }
+
+  // Hyperbolic trigonometric functions
+
+  /* Hyperbolic sine. */
+  template<Expression E>
+  UnaryExpression<Operations::HyperbolicSine, E> sinh(const E &expression) {
+    return UnaryExpression<Operations::HyperbolicSine, E>(expression);
+  }
+
+  /* Hyperbolic cosine. */
+  template<Expression E>
+  UnaryExpression<Operations::HyperbolicCosine, E> cosh(const E &expression) {
+    return UnaryExpression<Operations::HyperbolicCosine, E>(expression);
+  }
+
+  /* Hyperbolic tangent. */
+  template<Expression E>
+  UnaryExpression<Operations::HyperbolicTangent, E> tanh(const E &expression) {
+    return UnaryExpression<Operations::HyperbolicTangent, E>(expression);
+  }
+
+  /* Hyperbolic secant. */
+  template<Expression E>
+  UnaryExpression<Operations::HyperbolicSecant, E> sech(const E &expression) {
+    return UnaryExpression<Operations::HyperbolicSecant, E>(expression);
+  }
+
+  /* Hyperbolic cosecant. */
+  template<Expression E>
+  UnaryExpression<Operations::HyperbolicCosecant, E> csch(const E &expression) {
+    return UnaryExpression<Operations::HyperbolicCosecant, E>(expression);
+  }
+
+  /* Hyperbolic cotangent. */
+  template<Expression E>
+  UnaryExpression<Operations::HyperbolicCotangent, E> coth(const E &expression) {
+    return UnaryExpression<Operations::HyperbolicCotangent, E>(expression);
+  }
+
+  /* Inverse hyperbolic sine. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseHyperbolicSine, E> arsinh(const E &expression) {
+    return UnaryExpression<Operations::InverseHyperbolicSine, E>(expression);
+  }
+
+  /* Inverse hyperbolic cosine. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseHyperbolicCosine, E> arcosh(const E &expression) {
+    return UnaryExpression<Operations::InverseHyperbolicCosine, E>(expression);
+  }
+
+  /* Inverse hyperbolic tangent. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseHyperbolicTangent, E> artanh(const E &expression) {
+    return UnaryExpression<Operations::InverseHyperbolicTangent, E>(expression);
+  }
+
+  /* Inverse hyperbolic secant. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseHyperbolicSecant, E> arsech(const E &expression) {
+    return UnaryExpression<Operations::InverseHyperbolicSecant, E>(expression);
+  }
+
+  /* Inverse hyperbolic cosecant. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseHyperbolicCosecant, E> arcsch(const E &expression) {
+    return UnaryExpression<Operations::InverseHyperbolicCosecant, E>(expression);
+  }
+
+  /* Inverse hyperbolic cotangent. */
+  template<Expression E>
+  UnaryExpression<Operations::InverseHyperbolicCotangent, E> arcoth(const E &expression) {
+    return UnaryExpression<Operations::InverseHyperbolicCotangent, E>(expression);
+  }
+
+  /* Absolute value. */
+  template<Expression E>
+  UnaryExpression<Operations::AbsoluteValue, E> abs(const E &expression) {
+    return UnaryExpression<Operations::AbsoluteValue, E>(expression);
+  }
+}
+
+
+#endif // AUTOGRAD_EXPRESSION_HPP
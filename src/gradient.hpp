@@ -10,28 +10,85 @@ namespace AutoGrad {
   template<FloatingPoint Scalar>
   class Variable; // Forward declaration
 
+  template<FloatingPoint Scalar>
+  class ParallelTape; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Matrix; // Forward declaration
+
   /* Contains information about the gradient of a particular tape: the partial derivatives of a single output variable
-  with respect to all input variables. */
+  with respect to all input variables (or only a subset of them, see `Variable::gradient(inputs)`). */
   template<FloatingPoint Scalar>
   class Gradient {
     friend class Variable<Scalar>;
+    friend class ParallelTape<Scalar>;
 
   public:
 
-    /* Retrieve the partial derivative with respect to the given variable. */
+    /* Retrieve the partial derivative with respect to the given variable. For a gradient over a subset of the input
+    variables, this searches the subset and so takes linear time (prefer `operator[]` when iterating over it). */
     Scalar withRespectTo(const Variable<Scalar> &variable) const {
       if (&tape != &variable.tape) {
         throw std::invalid_argument("`AutoGrad::Variable` not from the same `AutoGrad::Tape` as `AutoGrad::Gradient`");
       }
-      return gradients[variable.index];
+      tape.validate(variable);
+      if (!sparse) {
+        return (variable.index < gradients.size()) ? gradients[variable.index] : 0.0;
+      }
+      auto input = std::find(indices.begin(), indices.end(), variable.index);
+      if (input == indices.end()) {
+        throw std::invalid_argument("`AutoGrad::Variable` not among the inputs of `AutoGrad::Gradient`");
+      }
+      return gradients[static_cast<size_t>(input - indices.begin())];
+    }
+
+    /* Retrieve the partial derivatives with respect to the elements of the given matrix (in row-major order). */
+    std::vector<Scalar> withRespectTo(const Matrix<Scalar> &matrix) const {
+      if (&tape != matrix.tape) {
+        throw std::invalid_argument("`AutoGrad::Matrix` not from the same `AutoGrad::Tape` as `AutoGrad::Gradient`");
+      }
+      tape.validate(matrix);
+      std::vector<Scalar> result(matrix.height * matrix.width, 0.0);
+      if (matrix.index == Tape<Scalar>::passive) {
+        return result;
+      }
+      for (size_t element = 0; element < result.size(); element++) {
+        size_t index = matrix.index + element;
+        if (!sparse) {
+          result[element] = (index < gradients.size()) ? gradients[index] : 0.0;
+          continue;
+        }
+        auto input = std::find(indices.begin(), indices.end(), index);
+        if (input == indices.end()) {
+          throw std::invalid_argument("`AutoGrad::Matrix` not among the inputs of `AutoGrad::Gradient`");
+        }
+        result[element] = gradients[static_cast<size_t>(input - indices.begin())];
+      }
+      return result;
+    }
+
+    /* Retrieve the partial derivative with respect to the input variable at the given position in the subset that the
+    gradient was computed over (or to the variable with the given index in the tape, for a full gradient). */
+    Scalar operator[](size_t position) const {
+      return gradients[position];
+    }
+
+    /* Retrieve the number of partial derivatives stored. */
+    size_t size() const noexcept {
+      return gradients.size();
     }
 
   private:
     Tape<Scalar> &tape; // Tape that the gradient was computed on.
     std::vector<Scalar> gradients; // Partial derivatives w.r.t each input variable.
+    std::vector<Index> indices; // Indices of the input variables for a gradient over a subset of them.
+    bool sparse = false; // Whether the gradient is over a subset of the input variables.
+
+    /* Construct a gradient object for a particular tape given the gradients w.r.t all of its variables. */
+    Gradient(Tape<Scalar> &tape_, std::vector<Scalar> gradients_) noexcept : tape(tape_), gradients(std::move(gradients_)) {}; // Constructor
 
-    /* Construct a gradient object for a particular tape given the gradients. */
-    Gradient(Tape<Scalar> &tape_, std::vector<Scalar> gradients_) noexcept : tape(tape_), gradients(gradients_) {}; // Constructor
+    /* Construct a gradient object for a particular tape given the gradients w.r.t the variables with the given indices. */
+    Gradient(Tape<Scalar> &tape_, std::vector<Scalar> gradients_, std::vector<Index> indices_) noexcept : tape(tape_), gradients(std::move(gradients_)), indices(std::move(indices_)), sparse(true) {}; // Constructor
   };
 }
 
@@ -0,0 +1,216 @@
+#ifndef AUTOGRAD_HESSIAN_HPP
+#define AUTOGRAD_HESSIAN_HPP
+
+
+#include "dual.hpp"
+#include "gradient.hpp"
+#include "tape.hpp"
+#include "utils.hpp"
+#include "variable.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class Hessian; // Forward declaration
+
+  template<FloatingPoint Scalar, size_t Width = 8, typename Function>
+  Hessian<Scalar> hessian(Function function, std::span<const Scalar> point); // Forward declaration
+
+  template<FloatingPoint Scalar, size_t Width = 8, typename Function>
+  Hessian<Scalar> hessian(Function function, std::span<const Scalar> point, std::span<const std::pair<size_t, size_t>> pattern); // Forward declaration
+
+  /* Contains the Hessian of a scalar function at a point (see `AutoGrad::hessian()`): the second-order partial
+  derivative with respect to each pair of inputs. A dense Hessian stores every entry in row-major order, while a sparse
+  one stores only the entries of its sparsity pattern in compressed sparse row form. */
+  template<FloatingPoint Scalar>
+  class Hessian {
+    template<FloatingPoint S, size_t Width, typename Function>
+    friend Hessian<S> hessian(Function function, std::span<const S> point);
+
+    template<FloatingPoint S, size_t Width, typename Function>
+    friend Hessian<S> hessian(Function function, std::span<const S> point, std::span<const std::pair<size_t, size_t>> pattern);
+
+  public:
+
+    /* Retrieve the second-order partial derivative with respect to the inputs at the given positions. For a sparse
+    Hessian, entries outside the sparsity pattern are zero and finding an entry takes logarithmic time in the number
+    of entries in its row. */
+    Scalar operator()(size_t row, size_t column) const {
+      if (!sparse) {
+        return values[row * inputs + column];
+      }
+      auto begin = columns.begin() + static_cast<std::ptrdiff_t>(offsets[row]);
+      auto end = columns.begin() + static_cast<std::ptrdiff_t>(offsets[row + 1]);
+      auto entry = std::lower_bound(begin, end, column);
+      return (entry != end && *entry == column) ? values[static_cast<size_t>(entry - columns.begin())] : 0.0;
+    }
+
+    /* Retrieve the number of rows and columns (input variables). */
+    size_t size() const noexcept {
+      return inputs;
+    }
+
+    /* Retrieve the number of reverse sweeps that were needed to compute the Hessian. */
+    size_t sweeps() const noexcept {
+      return passes;
+    }
+
+  private:
+    size_t inputs; // Number of input variables (rows and columns).
+    bool sparse; // Whether only the entries of a sparsity pattern are stored.
+    std::vector<size_t> offsets; // Position of each row's first entry (sparse only, with a final end position).
+    std::vector<size_t> columns; // Column of each entry, in increasing order within each row (sparse only).
+    std::vector<Scalar> values; // Second-order partial derivatives.
+    size_t passes = 0; // Number of reverse sweeps.
+
+    /* Construct a Hessian object of the given size with the given sparsity pattern (in compressed sparse row form). */
+    Hessian(size_t inputs_, bool sparse_, std::vector<size_t> offsets_, std::vector<size_t> columns_) : inputs{inputs_}, sparse{sparse_}, offsets(std::move(offsets_)), columns(std::move(columns_)) {} // Constructor
+
+    /* Compute the entries of the Hessian of the given function at the given point. Columns that never have an entry in
+    the same row are given the same color and their Hessian-vector products are computed together, since the sum of the
+    columns still determines every entry of each column; a dense Hessian gives every column its own color. The colors
+    are seeded as the directions of `Dual<Scalar, Width>` numbers so that each recording of the function and reverse
+    sweep over it yields `Width` Hessian-vector products at once. */
+    template<size_t Width, typename Function>
+    void compute(Function &function, std::span<const Scalar> point) {
+      static_assert(Width > 0, "`Width` must be positive");
+      std::vector<size_t> colors(inputs);
+      size_t count = 0;
+      if (!sparse) {
+        std::iota(colors.begin(), colors.end(), 0);
+        count = inputs;
+        values.assign(inputs * inputs, 0.0);
+      } else {
+        // Greedy coloring in which two columns conflict if they have an entry in the same row (the pattern is
+        // symmetric, so the rows in which a column has entries are the columns of its own row).
+        std::vector<size_t> forbidden(inputs, std::numeric_limits<size_t>::max());
+        for (size_t column = 0; column < inputs; column++) {
+          for (size_t entry = offsets[column]; entry < offsets[column + 1]; entry++) {
+            size_t row = columns[entry];
+            for (size_t other = offsets[row]; other < offsets[row + 1] && columns[other] < column; other++) {
+              forbidden[colors[columns[other]]] = column;
+            }
+          }
+          size_t color = 0;
+          while (forbidden[color] == column) {
+            color++;
+          }
+          colors[column] = color;
+          count = std::max(count, color + 1);
+        }
+        values.assign(columns.size(), 0.0);
+      }
+      using Number = Dual<Scalar, Width>;
+      for (size_t block = 0; block < count; block += Width) {
+        Tape<Number> tape;
+        std::vector<Variable<Number>> variables;
+        variables.reserve(inputs);
+        for (size_t input = 0; input < inputs; input++) {
+          std::array<Scalar, Width> seed{};
+          if (colors[input] >= block && colors[input] - block < Width) {
+            seed[colors[input] - block] = 1.0;
+          }
+          variables.push_back(tape.variable(Number(point[input], seed)));
+        }
+        Variable<Number> output = function(std::span<const Variable<Number>>(variables));
+        Gradient<Number> gradient = output.gradient(std::span<const Variable<Number>>(variables));
+        passes++;
+        for (size_t row = 0; row < inputs; row++) {
+          if (!sparse) {
+            for (size_t column = block; column < std::min(block + Width, inputs); column++) {
+              values[row * inputs + column] = gradient[row].derivative(column - block);
+            }
+            continue;
+          }
+          for (size_t entry = offsets[row]; entry < offsets[row + 1]; entry++) {
+            size_t color = colors[columns[entry]];
+            if (color >= block && color - block < Width) {
+              values[entry] = gradient[row].derivative(color - block);
+            }
+          }
+        }
+      }
+    }
+  };
+
+  /* Compute the product of the Hessian of a scalar function at the given point with the given direction vector. The
+  function is called once as `function(inputs)`, where `inputs` is a `std::span<const Variable<Dual<Scalar>>>` with one
+  variable per coordinate of the point, and must return a variable computed from them (on the same tape). Since the
+  inputs carry the direction as their tangents, so do the weights recorded on the tape, and a single reverse sweep in
+  dual arithmetic yields the gradient and its directional derivative (forward-over-reverse). */
+  template<FloatingPoint Scalar, typename Function>
+  std::vector<Scalar> hessianVectorProduct(Function function, std::span<const Scalar> point, std::span<const Scalar> direction) {
+    if (point.size() != direction.size()) {
+      throw std::invalid_argument("Point and direction of different sizes given to `AutoGrad::hessianVectorProduct()`");
+    }
+    using Number = Dual<Scalar>;
+    Tape<Number> tape;
+    std::vector<Variable<Number>> variables;
+    variables.reserve(point.size());
+    for (size_t input = 0; input < point.size(); input++) {
+      variables.push_back(tape.variable(Number(point[input], std::array<Scalar, 1>{direction[input]})));
+    }
+    Variable<Number> output = function(std::span<const Variable<Number>>(variables));
+    Gradient<Number> gradient = output.gradient(std::span<const Variable<Number>>(variables));
+    std::vector<Scalar> product(point.size());
+    for (size_t input = 0; input < point.size(); input++) {
+      product[input] = gradient[input].derivative(0);
+    }
+    return product;
+  }
+
+  /* Compute the full (dense) Hessian of a scalar function at the given point, which takes one recording of the
+  function and one reverse sweep per `Width` inputs. The function is called as for `hessianVectorProduct()`, but with
+  inputs of type `std::span<const Variable<Dual<Scalar, Width>>>` (so it is typically a generic lambda). */
+  template<FloatingPoint Scalar, size_t Width, typename Function>
+  Hessian<Scalar> hessian(Function function, std::span<const Scalar> point) {
+    Hessian<Scalar> hessian_(point.size(), false, {}, {});
+    hessian_.template compute<Width>(function, point);
+    return hessian_;
+  }
+
+  /* Compute the Hessian of a scalar function at the given point with the given sparsity pattern, i.e. the positions of
+  the entries that may be nonzero (every other entry is taken to be zero, and the pattern is made symmetric). Inputs
+  that never interact are seeded together, so the number of recordings and reverse sweeps depends on the number of
+  entries per row rather than the number of inputs (e.g. a single one for a tridiagonal Hessian with `Width` >= 3). */
+  template<FloatingPoint Scalar, size_t Width, typename Function>
+  Hessian<Scalar> hessian(Function function, std::span<const Scalar> point, std::span<const std::pair<size_t, size_t>> pattern) {
+    size_t inputs = point.size();
+    std::vector<size_t> offsets(inputs + 1, 0);
+    for (auto [row, column] : pattern) {
+      if (row >= inputs || column >= inputs) {
+        throw std::out_of_range("Sparsity pattern out of range for `AutoGrad::hessian()`");
+      }
+      offsets[row + 1]++;
+      offsets[column + 1] += (row != column);
+    }
+    for (size_t row = 0; row < inputs; row++) {
+      offsets[row + 1] += offsets[row];
+    }
+    std::vector<size_t> columns(offsets.back());
+    std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+    for (auto [row, column] : pattern) {
+      columns[positions[row]++] = column;
+      if (row != column) {
+        columns[positions[column]++] = row;
+      }
+    }
+    // Sort each row and drop duplicate entries.
+    size_t entries = 0;
+    for (size_t row = 0; row < inputs; row++) {
+      auto begin = columns.begin() + static_cast<std::ptrdiff_t>(offsets[row]);
+      auto end = columns.begin() + static_cast<std::ptrdiff_t>(offsets[row + 1]);
+      std::sort(begin, end);
+      end = std::unique(begin, end);
+      offsets[row] = entries;
+      entries = static_cast<size_t>(std::move(begin, end, columns.begin() + static_cast<std::ptrdiff_t>(entries)) - columns.begin());
+    }
+    offsets[inputs] = entries;
+    columns.resize(entries);
+    Hessian<Scalar> hessian_(inputs, true, std::move(offsets), std::move(columns));
+    hessian_.template compute<Width>(function, point);
+    return hessian_;
+  }
+}
+
+
+#endif // AUTOGRAD_HESSIAN_HPP
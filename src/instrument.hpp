@@ -0,0 +1,204 @@
+#ifndef AUTOGRAD_INSTRUMENT_HPP
+#define AUTOGRAD_INSTRUMENT_HPP
+
+
+#include "opcode.hpp"
+#include "utils.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class Tape; // Forward declaration
+
+#ifdef AUTOGRAD_INSTRUMENT
+  /* Counters that a tape keeps about what it records and how long it spends sweeping (only if `AUTOGRAD_INSTRUMENT` is
+  defined, see `Tape::instrumentation()`), e.g. to find out which operations and which parts of a model make a tape
+  larger than expected. They accumulate over the lifetime of the tape, across rewinds. */
+  class Instrumentation {
+    template<FloatingPoint Scalar>
+    friend class Tape;
+
+    template<FloatingPoint Scalar>
+    friend class Site;
+
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /* Retrieve the number of nodes recorded with the given op code. */
+    size_t nodes(Opcode code) const noexcept {
+      return counts[code];
+    }
+
+    /* Retrieve the largest amount of memory that the nodes and edges of the tape have used (see
+    `Tape::Statistics::bytes`), as of the last node recorded. */
+    size_t peakBytes() const noexcept {
+      return peak;
+    }
+
+    /* Retrieve the amount of memory allocated for the nodes and edges of the tape (used or not). */
+    size_t allocatedBytes() const noexcept {
+      return allocated;
+    }
+
+    /* Retrieve the number of blocks allocated for the nodes and edges of the tape (see `AutoGrad::Arena`). The arrays
+    of a tape are never reallocated, so this is the number of times that they had to grow. */
+    size_t allocations() const noexcept {
+      return blocks;
+    }
+
+    /* Retrieve the time elapsed since the tape was created outside of sweeps, which includes recording but also
+    whatever the program does in between (recording itself is not timed, so that it is not slowed down). */
+    Clock::duration outsideSweeps() const noexcept {
+      return Clock::now() - start - sweeping();
+    }
+
+    /* Retrieve the time spent sweeping the tape to compute gradients, Jacobians and Hessians. */
+    Clock::duration sweeping() const noexcept {
+      return swept;
+    }
+
+    /* Retrieve the number of nodes recorded at each site (see `AutoGrad::Site`), from the one with the most nodes. Nodes
+    recorded outside of every site are attributed to a site labeled "(no site)". */
+    std::vector<std::pair<std::string, size_t>> sites() const {
+      std::vector<std::pair<std::string, size_t>> sorted = labels;
+      std::stable_sort(sorted.begin(), sorted.end(), [](const auto &site1, const auto &site2) {
+        return site1.second > site2.second;
+      });
+      return sorted;
+    }
+
+    /* Retrieve the name of the function in `autograd.hpp` that records nodes with the given op code, together with the
+    kinds of its operands for binary operations. */
+    static std::string name(Opcode code) {
+      static constexpr std::array<const char *, Opcodes::unaries> unaryNames = {"operator-", "sqrt", "cbrt", "exp", "exp2", "log", "log2", "log10", "sin", "cos", "tan", "sec", "csc", "cot", "arcsin", "arccos", "arctan", "arcsec", "arccsc", "arccot", "sinh", "cosh", "tanh", "sech", "csch", "coth", "arsinh", "arcosh", "artanh", "arsech", "arcsch", "arcoth", "abs"};
+      static constexpr std::array<const char *, Opcodes::binaries> binaryNames = {"operator+", "operator-", "operator*", "operator/", "pow", "log"};
+      switch (Opcodes::kind(code)) {
+        case Opcodes::Kind::Leaf:
+          return "variable";
+        case Opcodes::Kind::Copy:
+          return "copy";
+        case Opcodes::Kind::Opaque:
+          return "fused expression or matrix";
+        case Opcodes::Kind::Unary:
+          return unaryNames[code - 3];
+        case Opcodes::Kind::Binary:
+          return std::string(binaryNames[(code - 3 - Opcodes::unaries) % Opcodes::binaries]) + "(variable, variable)";
+        case Opcodes::Kind::Left:
+          return std::string(binaryNames[(code - 3 - Opcodes::unaries) % Opcodes::binaries]) + "(variable, scalar)";
+        default:
+          return std::string(binaryNames[(code - 3 - Opcodes::unaries) % Opcodes::binaries]) + "(scalar, variable)";
+      }
+    }
+
+    /* Write a summary to the given stream: the memory and time used, the number of nodes recorded by each operation and
+    the sites that recorded the most nodes (up to the given number). */
+    void print(std::ostream &stream, size_t top = 10) const {
+      using Milliseconds = std::chrono::duration<double, std::milli>;
+      stream << "Outside sweeps: " << Milliseconds(outsideSweeps()).count() << " ms, sweeping: " << Milliseconds(sweeping()).count() << " ms\n";
+      stream << "Peak bytes: " << peakBytes() << ", allocated bytes: " << allocatedBytes() << " (" << allocations() << " blocks)\n";
+      stream << "Nodes by operation:\n";
+      for (size_t code = 0; code < counts.size(); code++) {
+        if (counts[code] > 0) {
+          stream << "  " << std::left << std::setw(32) << name(static_cast<Opcode>(code)) << std::right << std::setw(12) << counts[code] << '\n';
+        }
+      }
+      stream << "Nodes by site:\n";
+      std::vector<std::pair<std::string, size_t>> sorted = sites();
+      for (size_t position = 0; position < std::min(top, sorted.size()); position++) {
+        if (sorted[position].second > 0) {
+          stream << "  " << std::left << std::setw(32) << sorted[position].first << std::right << std::setw(12) << sorted[position].second << '\n';
+        }
+      }
+    }
+
+  private:
+    std::array<size_t, std::numeric_limits<Opcode>::max() + 1> counts = {}; // Number of nodes recorded with each op code.
+    size_t peak = 0; // Largest number of bytes used by the nodes and edges.
+    size_t allocated = 0; // Number of bytes allocated for the nodes and edges.
+    size_t blocks = 0; // Number of blocks allocated for the nodes and edges.
+    Clock::time_point start = Clock::now(); // When the tape was created.
+    Clock::duration swept = Clock::duration::zero(); // Time spent sweeping.
+    std::vector<std::pair<std::string, size_t>> labels = {{"(no site)", 0}}; // Label and number of nodes of each site.
+    size_t site = 0; // Position of the innermost site in scope in `labels`.
+
+    /* Count a node recorded with the given op code when the nodes and edges used the given number of bytes. */
+    void record(Opcode code, size_t bytes) noexcept {
+      counts[code]++;
+      labels[site].second++;
+      peak = std::max(peak, bytes);
+    }
+
+    /* Adds the time for which it is in scope to the time spent sweeping. */
+    class Timer {
+    public:
+      /* Construct a new timer object for the given counters. */
+      explicit Timer(Instrumentation &instrumentation_) noexcept : instrumentation(instrumentation_), begin{Clock::now()} {} // Constructor
+
+      // Disallow copy semantics
+      Timer(const Timer &timer) = delete; // Copy constructor
+      Timer &operator=(const Timer &timer) = delete; // Copy assignment operator
+
+      /* Destroy the timer object, adding the time since it was constructed. */
+      ~Timer() { // Destructor
+        instrumentation.swept += Clock::now() - begin;
+      }
+
+    private:
+      Instrumentation &instrumentation; // Counters to add the time to.
+      Clock::time_point begin; // When the timer was constructed.
+    };
+  };
+
+  /* Attributes the nodes recorded on a tape while it is in scope to the given label (see
+  `Instrumentation::sites()`), e.g. the name of a layer of a model or of the function that records them. Sites can be
+  nested, in which case nodes are attributed to the innermost one. Unless `AUTOGRAD_INSTRUMENT` is defined, a site does
+  nothing and is compiled out. */
+  template<FloatingPoint Scalar>
+  class Site {
+  public:
+    /* Construct a new site object with the given label on the given tape. */
+    Site(Tape<Scalar> &tape_, std::string_view label) : instrumentation(tape_.profile), previous{tape_.profile.site} { // Constructor
+      std::vector<std::pair<std::string, size_t>> &labels = instrumentation.labels;
+      auto found = std::find_if(labels.begin(), labels.end(), [&](const auto &site) {
+        return site.first == label;
+      });
+      if (found == labels.end()) {
+        labels.emplace_back(label, 0);
+        found = labels.end() - 1;
+      }
+      instrumentation.site = static_cast<size_t>(found - labels.begin());
+    }
+
+    // Disallow copy semantics
+    // Each site restores the enclosing one exactly once, when it is destroyed.
+    Site(const Site<Scalar> &site) = delete; // Copy constructor
+    Site<Scalar> &operator=(const Site<Scalar> &site) = delete; // Copy assignment operator
+
+    /* Destroy the site object, attributing nodes to the enclosing site again. */
+    ~Site() { // Destructor
+      instrumentation.site = previous;
+    }
+
+  private:
+    Instrumentation &instrumentation; // Counters of the tape.
+    size_t previous; // Position of the enclosing site.
+  };
+#else
+  /* Attributes the nodes recorded on a tape while it is in scope to the given label (see
+  `Instrumentation::sites()`), e.g. the name of a layer of a model or of the function that records them. Sites can be
+  nested, in which case nodes are attributed to the innermost one. Unless `AUTOGRAD_INSTRUMENT` is defined, a site does
+  nothing and is compiled out. */
+  template<FloatingPoint Scalar>
+  class Site {
+  public:
+    /* Construct a new site object with the given label on the given tape (which does nothing). */
+    constexpr Site(Tape<Scalar> &, std::string_view) noexcept {} // Constructor
+
+    // Disallow copy semantics
+    Site(const Site<Scalar> &site) = delete; // Copy constructor
+    Site<Scalar> &operator=(const Site<Scalar> &site) = delete; // Copy assignment operator
+  };
+#endif
+}
+
+
+#endif // AUTOGRAD_INSTRUMENT_HPP
@@ -0,0 +1,47 @@
+
+#ifndef AUTOGRAD_JACOBIAN_HPP
+#define AUTOGRAD_JACOBIAN_HPP
+
+
+#include "utils.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class Tape; // Forward declaration
+
+  /* Contains the Jacobian of a set of output variables with respect to a set of input variables: the partial
+  derivative of each output with respect to each input, stored in row-major order (one row per output). */
+  template<FloatingPoint Scalar>
+  class Jacobian {
+    friend class Tape<Scalar>;
+
+  public:
+
+    /* Retrieve the partial derivative of the output at the given row with respect to the input at the given column
+    (positions refer to the order in which the variables were passed to `Tape::jacobian()`). */
+    Scalar operator()(size_t row, size_t column) const {
+      return values[row * inputs + column];
+    }
+
+    /* Retrieve the number of rows (output variables). */
+    size_t rows() const noexcept {
+      return outputs;
+    }
+
+    /* Retrieve the number of columns (input variables). */
+    size_t columns() const noexcept {
+      return inputs;
+    }
+
+  private:
+    size_t outputs; // Number of output variables (rows).
+    size_t inputs; // Number of input variables (columns).
+    std::vector<Scalar> values; // Partial derivatives in row-major order.
+
+    /* Construct a Jacobian object of the given shape with all partial derivatives set to zero. */
+    Jacobian(size_t outputs_, size_t inputs_) : outputs{outputs_}, inputs{inputs_}, values(outputs_ * inputs_, 0.0) {} // Constructor
+  };
+}
+
+
+#endif // AUTOGRAD_JACOBIAN_HPP
@@ -0,0 +1,272 @@
+#ifndef AUTOGRAD_KERNEL_HPP
+#define AUTOGRAD_KERNEL_HPP
+
+
+#include "operations.hpp"
+#include "utils.hpp"
+
+namespace AutoGrad {
+
+  /* An operation on whole matrices that is recorded on a tape as a single kernel instead of as one edge per partial
+  derivative (see `AutoGrad::Matrix`). The elements of the result are recorded as consecutive nodes without edges, and
+  when the reverse sweep reaches the first of them, the kernel propagates the adjoints of all of them to its operands
+  at once by computing a vector-Jacobian product. */
+  template<FloatingPoint Scalar>
+  class Kernel {
+  public:
+    /* Destroy the kernel object. */
+    virtual ~Kernel() = default; // Destructor
+
+    /* Add the vector-Jacobian product of the adjoints of the outputs (the nodes starting at the given index) to the
+    adjoints of the operands. The adjoints of node `i` are stored at `[i * width, (i + 1) * width)`; nodes past the end of
+    the adjoints are not needed by the sweep and have an adjoint of zero. */
+    virtual void backward(std::span<Scalar> adjoints, size_t width, Index output) const = 0;
+  };
+}
+
+/* Contains the kernels for the operations on matrices implemented by AutoGrad (see `AutoGrad::Kernel`). Matrices are
+stored in row-major order. The loops over matrix products are blocked so that the operands stay in cache and the
+innermost loops run over contiguous rows so that the compiler can vectorize them. */
+namespace AutoGrad::Kernels {
+
+  /* Number of rows and columns of the blocks that matrix products are computed in. */
+  constexpr size_t tile = 64;
+
+  /* Add the product of a `rows` x `inner` matrix and an `inner` x `columns` matrix to a `rows` x `columns` matrix. */
+  template<typename T>
+  void multiply(const T *left, const T *right, T *result, size_t rows, size_t inner, size_t columns) {
+    for (size_t row0 = 0; row0 < rows; row0 += tile) {
+      for (size_t inner0 = 0; inner0 < inner; inner0 += tile) {
+        for (size_t column0 = 0; column0 < columns; column0 += 4 * tile) {
+          size_t rowEnd = std::min(row0 + tile, rows);
+          size_t innerEnd = std::min(inner0 + tile, inner);
+          size_t columnEnd = std::min(column0 + 4 * tile, columns);
+          for (size_t row = row0; row < rowEnd; row++) {
+            T *target = result + row * columns;
+            for (size_t k = inner0; k < innerEnd; k++) {
+              T factor = left[row * inner + k];
+              const T *source = right + k * columns;
+              for (size_t column = column0; column < columnEnd; column++) {
+                target[column] += factor * source[column];
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /* Transpose a `rows` x `columns` matrix. */
+  template<typename T>
+  std::vector<T> transpose(const T *matrix, size_t rows, size_t columns) {
+    std::vector<T> result(rows * columns);
+    for (size_t row0 = 0; row0 < rows; row0 += tile) {
+      for (size_t column0 = 0; column0 < columns; column0 += tile) {
+        for (size_t row = row0; row < std::min(row0 + tile, rows); row++) {
+          for (size_t column = column0; column < std::min(column0 + tile, columns); column++) {
+            result[column * rows + row] = matrix[row * columns + column];
+          }
+        }
+      }
+    }
+    return result;
+  }
+
+  /* Retrieve one lane of the adjoints of `count` consecutive nodes starting at the given index. */
+  template<typename T>
+  std::vector<T> gather(std::span<const T> adjoints, size_t width, size_t lane, Index first, size_t count) {
+    std::vector<T> result(count, 0.0);
+    size_t end = std::min(count, adjoints.size() / width - std::min(adjoints.size() / width, static_cast<size_t>(first)));
+    for (size_t element = 0; element < end; element++) {
+      result[element] = adjoints[(first + element) * width + lane];
+    }
+    return result;
+  }
+
+  /* Add values to one lane of the adjoints of consecutive nodes starting at the given index (nothing for a constant
+  operand, whose index is that of constants, see `Tape::constant()`). */
+  template<typename T>
+  void scatter(std::span<T> adjoints, size_t width, size_t lane, Index first, const std::vector<T> &values) {
+    if (first == std::numeric_limits<Index>::max()) {
+      return;
+    }
+    for (size_t element = 0; element < values.size(); element++) {
+      adjoints[(first + element) * width + lane] += values[element];
+    }
+  }
+
+  /* The shape of a matrix operand and the position of its first element on the tape. */
+  struct Operand {
+    Index index; // Index of the node of the first element.
+    size_t rows; // Number of rows.
+    size_t columns; // Number of columns.
+
+    /* Retrieve the position of the element that is broadcast to the given position of a result with more rows or
+    columns (operands with a single row or column are repeated along it). */
+    size_t broadcast(size_t row, size_t column) const noexcept {
+      return ((rows == 1) ? 0 : row) * columns + ((columns == 1) ? 0 : column);
+    }
+  };
+
+  /* Matrix product. */
+  template<FloatingPoint Scalar>
+  class Product : public Kernel<Scalar> {
+  public:
+    Product(Operand left_, std::shared_ptr<const std::vector<Scalar>> leftValues_, Operand right_, std::shared_ptr<const std::vector<Scalar>> rightValues_) : left{left_}, right{right_}, leftValues(std::move(leftValues_)), rightValues(std::move(rightValues_)) {} // Constructor
+
+    void backward(std::span<Scalar> adjoints, size_t width, Index output) const override {
+      // With `C = A B`, the adjoints are `A' += C' B^T` and `B' += A^T C'`.
+      std::vector<Scalar> leftTransposed = transpose(leftValues->data(), left.rows, left.columns);
+      std::vector<Scalar> rightTransposed = transpose(rightValues->data(), right.rows, right.columns);
+      for (size_t lane = 0; lane < width; lane++) {
+        std::vector<Scalar> seed = gather<Scalar>(adjoints, width, lane, output, left.rows * right.columns);
+        std::vector<Scalar> leftAdjoints(left.rows * left.columns, 0.0);
+        std::vector<Scalar> rightAdjoints(right.rows * right.columns, 0.0);
+        multiply(seed.data(), rightTransposed.data(), leftAdjoints.data(), left.rows, right.columns, left.columns);
+        multiply(leftTransposed.data(), seed.data(), rightAdjoints.data(), left.columns, left.rows, right.columns);
+        scatter(adjoints, width, lane, left.index, leftAdjoints);
+        scatter(adjoints, width, lane, right.index, rightAdjoints);
+      }
+    }
+
+  private:
+    Operand left; // Left operand.
+    Operand right; // Right operand.
+    std::shared_ptr<const std::vector<Scalar>> leftValues; // Values of the left operand.
+    std::shared_ptr<const std::vector<Scalar>> rightValues; // Values of the right operand.
+  };
+
+  /* Transpose. */
+  template<FloatingPoint Scalar>
+  class Transpose : public Kernel<Scalar> {
+  public:
+    explicit Transpose(Operand operand_) noexcept : operand{operand_} {} // Constructor
+
+    void backward(std::span<Scalar> adjoints, size_t width, Index output) const override {
+      for (size_t lane = 0; lane < width; lane++) {
+        std::vector<Scalar> seed = gather<Scalar>(adjoints, width, lane, output, operand.rows * operand.columns);
+        scatter(adjoints, width, lane, operand.index, transpose(seed.data(), operand.columns, operand.rows));
+      }
+    }
+
+  private:
+    Operand operand; // Matrix that is transposed.
+  };
+
+  /* Unary operation (see `AutoGrad::Operations`) applied to each element. */
+  template<FloatingPoint Scalar, typename Operation>
+  class Elementwise : public Kernel<Scalar> {
+  public:
+    Elementwise(Operand operand_, std::shared_ptr<const std::vector<Scalar>> operandValues_, std::shared_ptr<const std::vector<Scalar>> values_) : operand{operand_}, operandValues(std::move(operandValues_)), values(std::move(values_)) {} // Constructor
+
+    void backward(std::span<Scalar> adjoints, size_t width, Index output) const override {
+      for (size_t lane = 0; lane < width; lane++) {
+        std::vector<Scalar> seed = gather<Scalar>(adjoints, width, lane, output, values->size());
+        for (size_t element = 0; element < seed.size(); element++) {
+          seed[element] *= Operation::derivative((*operandValues)[element], (*values)[element]);
+        }
+        scatter(adjoints, width, lane, operand.index, seed);
+      }
+    }
+
+  private:
+    Operand operand; // Matrix that the operation is applied to.
+    std::shared_ptr<const std::vector<Scalar>> operandValues; // Values of the operand.
+    std::shared_ptr<const std::vector<Scalar>> values; // Values of the result.
+  };
+
+  /* Binary operation (see `AutoGrad::Operations`) applied to each pair of elements, where operands with a single row
+  or column are broadcast along it. */
+  template<FloatingPoint Scalar, typename Operation>
+  class Broadcast : public Kernel<Scalar> {
+  public:
+    Broadcast(Operand left_, std::shared_ptr<const std::vector<Scalar>> leftValues_, Operand right_, std::shared_ptr<const std::vector<Scalar>> rightValues_, size_t rows_, size_t columns_, std::shared_ptr<const std::vector<Scalar>> values_) : left{left_}, right{right_}, rows{rows_}, columns{columns_}, leftValues(std::move(leftValues_)), rightValues(std::move(rightValues_)), values(std::move(values_)) {} // Constructor
+
+    void backward(std::span<Scalar> adjoints, size_t width, Index output) const override {
+      for (size_t lane = 0; lane < width; lane++) {
+        std::vector<Scalar> seed = gather<Scalar>(adjoints, width, lane, output, rows * columns);
+        std::vector<Scalar> leftAdjoints(left.rows * left.columns, 0.0);
+        std::vector<Scalar> rightAdjoints(right.rows * right.columns, 0.0);
+        for (size_t row = 0; row < rows; row++) {
+          for (size_t column = 0; column < columns; column++) {
+            size_t element = row * columns + column;
+            size_t leftElement = left.broadcast(row, column);
+            size_t rightElement = right.broadcast(row, column);
+            const Scalar &x = (*leftValues)[leftElement];
+            const Scalar &y = (*rightValues)[rightElement];
+            leftAdjoints[leftElement] += seed[element] * Operation::left(x, y, (*values)[element]);
+            rightAdjoints[rightElement] += seed[element] * Operation::right(x, y, (*values)[element]);
+          }
+        }
+        scatter(adjoints, width, lane, left.index, leftAdjoints);
+        scatter(adjoints, width, lane, right.index, rightAdjoints);
+      }
+    }
+
+  private:
+    Operand left; // Left operand.
+    Operand right; // Right operand.
+    size_t rows; // Number of rows of the result.
+    size_t columns; // Number of columns of the result.
+    std::shared_ptr<const std::vector<Scalar>> leftValues; // Values of the left operand.
+    std::shared_ptr<const std::vector<Scalar>> rightValues; // Values of the right operand.
+    std::shared_ptr<const std::vector<Scalar>> values; // Values of the result.
+  };
+
+  /* Binary operation (see `AutoGrad::Operations`) applied to each element and a scalar, which is the right operand
+  unless `Reversed` is true. */
+  template<FloatingPoint Scalar, typename Operation, bool Reversed>
+  class Constant : public Kernel<Scalar> {
+  public:
+    Constant(Operand operand_, std::shared_ptr<const std::vector<Scalar>> operandValues_, Scalar scalar_, std::shared_ptr<const std::vector<Scalar>> values_) : operand{operand_}, scalar{scalar_}, operandValues(std::move(operandValues_)), values(std::move(values_)) {} // Constructor
+
+    void backward(std::span<Scalar> adjoints, size_t width, Index output) const override {
+      for (size_t lane = 0; lane < width; lane++) {
+        std::vector<Scalar> seed = gather<Scalar>(adjoints, width, lane, output, values->size());
+        for (size_t element = 0; element < seed.size(); element++) {
+          if constexpr (Reversed) {
+            seed[element] *= Operation::right(scalar, (*operandValues)[element], (*values)[element]);
+          } else {
+            seed[element] *= Operation::left((*operandValues)[element], scalar, (*values)[element]);
+          }
+        }
+        scatter(adjoints, width, lane, operand.index, seed);
+      }
+    }
+
+  private:
+    Operand operand; // Matrix that the operation is applied to.
+    Scalar scalar; // Scalar operand.
+    std::shared_ptr<const std::vector<Scalar>> operandValues; // Values of the matrix operand.
+    std::shared_ptr<const std::vector<Scalar>> values; // Values of the result.
+  };
+
+  /* Sum of the elements of each column (to a row vector), of each row (to a column vector) or of all of them. */
+  template<FloatingPoint Scalar>
+  class Sum : public Kernel<Scalar> {
+  public:
+    Sum(Operand operand_, bool rows_, bool columns_) noexcept : operand{operand_}, rows{rows_}, columns{columns_} {} // Constructor
+
+    void backward(std::span<Scalar> adjoints, size_t width, Index output) const override {
+      Operand result{output, rows ? 1 : operand.rows, columns ? 1 : operand.columns};
+      for (size_t lane = 0; lane < width; lane++) {
+        std::vector<Scalar> seed = gather<Scalar>(adjoints, width, lane, output, result.rows * result.columns);
+        std::vector<Scalar> operandAdjoints(operand.rows * operand.columns);
+        for (size_t row = 0; row < operand.rows; row++) {
+          for (size_t column = 0; column < operand.columns; column++) {
+            operandAdjoints[row * operand.columns + column] = seed[result.broadcast(row, column)];
+          }
+        }
+        scatter(adjoints, width, lane, operand.index, operandAdjoints);
+      }
+    }
+
+  private:
+    Operand operand; // Matrix that is summed.
+    bool rows; // Whether the result has a single row (i.e. the rows are added together).
+    bool columns; // Whether the result has a single column (i.e. the columns are added together).
+  };
+}
+
+
+#endif // AUTOGRAD_KERNEL_HPP
@@ -0,0 +1,104 @@
+#ifndef AUTOGRAD_MAPPED_HPP
+#define AUTOGRAD_MAPPED_HPP
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "arena.hpp"
+#include "utils.hpp"
+
+namespace AutoGrad {
+
+  /* A memory resource that allocates memory from a temporary file mapped into memory (on POSIX systems), so that a tape
+  whose nodes and edges do not fit in memory (see `Tape::Tape(std::pmr::memory_resource *)`) is written out to disk by
+  the operating system instead of being killed for running out of memory. Blocks are allocated one after the other, so
+  recording streams through the file, and a reverse sweep prefetches each block of the tape before it reaches it, so
+  only the blocks of nodes and edges around the current position have to be in memory. The adjoints of a sweep (one
+  scalar per node, which an edge may add to at any earlier node) are not backed by the file and must still fit in
+  memory, so a sweep needs memory for its adjoints (and the dense `Gradient` it returns) rather than for the tape. Like
+  `std::pmr::monotonic_buffer_resource`, memory is only given back when the resource is destroyed, and the resource is
+  not thread-safe. */
+  class MappedResource : public PrefetchingResource {
+  public:
+    /* Construct a new resource backed by a temporary file in the given directory that can hold up to the given number
+    of bytes. The file is removed right away (so it disappears once the resource is destroyed, even if the program
+    crashes), and only uses disk space for the memory that is actually allocated. */
+    MappedResource(const std::string &directory, size_t capacity_) : capacity{capacity_} { // Constructor
+      if (capacity == 0) {
+        throw std::invalid_argument("Capacity of an `AutoGrad::MappedResource` must be positive");
+      }
+      std::string path = directory + "/autograd-XXXXXX";
+      descriptor = ::mkstemp(path.data());
+      if (descriptor < 0) {
+        throw std::system_error(errno, std::generic_category(), "Cannot create the file of an `AutoGrad::MappedResource`");
+      }
+      ::unlink(path.c_str());
+      if (::ftruncate(descriptor, static_cast<off_t>(capacity)) != 0) {
+        int error = errno;
+        ::close(descriptor);
+        throw std::system_error(error, std::generic_category(), "Cannot resize the file of an `AutoGrad::MappedResource`");
+      }
+      void *address = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+      if (address == MAP_FAILED) {
+        int error = errno;
+        ::close(descriptor);
+        throw std::system_error(error, std::generic_category(), "Cannot map the file of an `AutoGrad::MappedResource`");
+      }
+      base = static_cast<std::byte *>(address);
+      page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    }
+
+    // Disallow copy semantics
+    // The mapping is owned by a single resource.
+    MappedResource(const MappedResource &resource) = delete; // Copy constructor
+    MappedResource &operator=(const MappedResource &resource) = delete; // Copy assignment operator
+
+    /* Destroy the resource, unmapping and closing (and so removing) the file. */
+    ~MappedResource() override { // Destructor
+      ::munmap(base, capacity);
+      ::close(descriptor);
+    }
+
+    /* Retrieve the number of bytes allocated so far. */
+    size_t used() const noexcept {
+      return position;
+    }
+
+    /* Ask the operating system to start reading in the pages of the given range of memory. */
+    void prefetch(const void *address, size_t bytes) const noexcept override {
+      size_t begin = static_cast<size_t>(static_cast<const std::byte *>(address) - base) / page * page;
+      size_t end = static_cast<size_t>(static_cast<const std::byte *>(address) - base) + bytes;
+      ::madvise(base + begin, end - begin, MADV_WILLNEED);
+    }
+
+  private:
+    size_t capacity; // Size of the file (and the mapping) in bytes.
+    int descriptor; // File descriptor of the file.
+    std::byte *base; // Start of the mapping.
+    size_t page; // Size of a page in bytes.
+    size_t position = 0; // Number of bytes allocated so far.
+
+    /* Allocate memory after the memory allocated so far. */
+    void *do_allocate(size_t bytes, size_t alignment) override {
+      size_t begin = (position + alignment - 1) / alignment * alignment;
+      if (begin > capacity || bytes > capacity - begin) {
+        throw std::bad_alloc();
+      }
+      position = begin + bytes;
+      return base + begin;
+    }
+
+    /* Give memory back (which does nothing until the resource is destroyed). */
+    void do_deallocate(void *, size_t, size_t) override {}
+
+    /* Determine if memory allocated from the given resource can be given back to this one. */
+    bool do_is_equal(const std::pmr::memory_resource &resource) const noexcept override {
+      return this == &resource;
+    }
+  };
+}
+
+
+#endif // AUTOGRAD_MAPPED_HPP
@@ -0,0 +1,360 @@
+#ifndef AUTOGRAD_MATRIX_HPP
+#define AUTOGRAD_MATRIX_HPP
+
+
+#include "kernel.hpp"
+#include "operations.hpp"
+#include "tape.hpp"
+#include "utils.hpp"
+#include "variable.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class Tape; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Variable; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Gradient; // Forward declaration
+
+  /* A matrix of variables (stored in row-major order) whose operations are each recorded on the tape as a single
+  kernel (see `AutoGrad::Kernel`) rather than as one node per scalar operation: the elements of a result are recorded
+  as nodes without edges and the kernel computes the vector-Jacobian product for all of them at once in the reverse
+  sweep. A product of two `n` x `n` matrices thus records `n^2` nodes and no edges instead of `n^3` nodes. Each element
+  can still be accessed as a `Variable`, so matrices and scalar variables can be mixed freely.
+
+  Matrices are immutable handles, so copying one does not record anything and refers to the same nodes. Vectors are
+  matrices with a single row or column. Like variables, matrices created while recording is paused (see
+  `Tape::pause()`) are constants, which have no nodes: operations on constants only compute values, and kernels do not
+  propagate adjoints to a constant operand. */
+  template<FloatingPoint Scalar>
+  class Matrix {
+    friend class Tape<Scalar>;
+    friend class Gradient<Scalar>;
+
+    // Operations on matrices are defined as (non-template) friends so that they are found through argument-dependent
+    // lookup and scalars are implicitly converted to `Scalar`.
+
+    // Arithmetic operations (elementwise, broadcasting operands with a single row or column along it)
+
+    /* Addition. */
+    friend Matrix<Scalar> operator+(const Matrix<Scalar> &matrix1, const Matrix<Scalar> &matrix2) {
+      return broadcast<Operations::Addition>(matrix1, matrix2);
+    }
+
+    /* Addition. */
+    friend Matrix<Scalar> operator+(const Matrix<Scalar> &matrix, Scalar scalar) {
+      return constant<Operations::Addition, false>(matrix, scalar);
+    }
+
+    /* Addition. */
+    friend Matrix<Scalar> operator+(Scalar scalar, const Matrix<Scalar> &matrix) {
+      return constant<Operations::Addition, true>(matrix, scalar);
+    }
+
+    /* Subtraction. */
+    friend Matrix<Scalar> operator-(const Matrix<Scalar> &matrix1, const Matrix<Scalar> &matrix2) {
+      return broadcast<Operations::Subtraction>(matrix1, matrix2);
+    }
+
+    /* Subtraction. */
+    friend Matrix<Scalar> operator-(const Matrix<Scalar> &matrix, Scalar scalar) {
+      return constant<Operations::Subtraction, false>(matrix, scalar);
+    }
+
+    /* Subtraction. */
+    friend Matrix<Scalar> operator-(Scalar scalar, const Matrix<Scalar> &matrix) {
+      return constant<Operations::Subtraction, true>(matrix, scalar);
+    }
+
+    /* Multiplication. */
+    friend Matrix<Scalar> operator*(const Matrix<Scalar> &matrix1, const Matrix<Scalar> &matrix2) {
+      return broadcast<Operations::Multiplication>(matrix1, matrix2);
+    }
+
+    /* Multiplication. */
+    friend Matrix<Scalar> operator*(const Matrix<Scalar> &matrix, Scalar scalar) {
+      return constant<Operations::Multiplication, false>(matrix, scalar);
+    }
+
+    /* Multiplication. */
+    friend Matrix<Scalar> operator*(Scalar scalar, const Matrix<Scalar> &matrix) {
+      return constant<Operations::Multiplication, true>(matrix, scalar);
+    }
+
+    /* Division. */
+    friend Matrix<Scalar> operator/(const Matrix<Scalar> &matrix1, const Matrix<Scalar> &matrix2) {
+      return broadcast<Operations::Division>(matrix1, matrix2);
+    }
+
+    /* Division. */
+    friend Matrix<Scalar> operator/(const Matrix<Scalar> &matrix, Scalar scalar) {
+      return constant<Operations::Division, false>(matrix, scalar);
+    }
+
+    /* Division. */
+    friend Matrix<Scalar> operator/(Scalar scalar, const Matrix<Scalar> &matrix) {
+      return constant<Operations::Division, true>(matrix, scalar);
+    }
+
+    /* Negation. */
+    friend Matrix<Scalar> operator-(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::Negation>(matrix);
+    }
+
+    // Linear algebra operations
+
+    /* Matrix product. */
+    friend Matrix<Scalar> matmul(const Matrix<Scalar> &matrix1, const Matrix<Scalar> &matrix2) {
+      return product(matrix1, matrix2);
+    }
+
+    /* Transpose. */
+    friend Matrix<Scalar> transpose(const Matrix<Scalar> &matrix) {
+      return transposed(matrix);
+    }
+
+    /* Sum of all elements. */
+    friend Variable<Scalar> sum(const Matrix<Scalar> &matrix) {
+      return total(matrix);
+    }
+
+    /* Sum of the elements along the given dimension: of each column (to a row vector) for dimension 0 and of each row
+    (to a column vector) for dimension 1. */
+    friend Matrix<Scalar> sum(const Matrix<Scalar> &matrix, size_t dimension) {
+      if (dimension > 1) {
+        throw std::out_of_range("Dimension out of range for `AutoGrad::Matrix`");
+      }
+      return reduce(matrix, dimension == 0, dimension == 1);
+    }
+
+    // Elementwise elementary functions
+
+    /* Exponentiation (powers). */
+    friend Matrix<Scalar> pow(const Matrix<Scalar> &matrix, Scalar scalar) {
+      return constant<Operations::Power, false>(matrix, scalar);
+    }
+
+    /* Square root. */
+    friend Matrix<Scalar> sqrt(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::SquareRoot>(matrix);
+    }
+
+    /* Exponential function. */
+    friend Matrix<Scalar> exp(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::Exponential>(matrix);
+    }
+
+    /* Natural logarithm. */
+    friend Matrix<Scalar> log(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::NaturalLogarithm>(matrix);
+    }
+
+    /* Sine. */
+    friend Matrix<Scalar> sin(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::Sine>(matrix);
+    }
+
+    /* Cosine. */
+    friend Matrix<Scalar> cos(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::Cosine>(matrix);
+    }
+
+    /* Tangent. */
+    friend Matrix<Scalar> tan(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::Tangent>(matrix);
+    }
+
+    /* Hyperbolic sine. */
+    friend Matrix<Scalar> sinh(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::HyperbolicSine>(matrix);
+    }
+
+    /* Hyperbolic cosine. */
+    friend Matrix<Scalar> cosh(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::HyperbolicCosine>(matrix);
+    }
+
+    /* Hyperbolic tangent. */
+    friend Matrix<Scalar> tanh(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::HyperbolicTangent>(matrix);
+    }
+
+    /* Absolute value. */
+    friend Matrix<Scalar> abs(const Matrix<Scalar> &matrix) {
+      return elementwise<Operations::AbsoluteValue>(matrix);
+    }
+
+  public:
+    /* Retrieve the element at the given position as a variable. */
+    Variable<Scalar> operator()(size_t row, size_t column) const {
+      tape->validate(*this);
+      size_t element = position(row, column);
+      return Variable<Scalar>(*tape, (*vals)[element], (index != Tape<Scalar>::passive) ? static_cast<Index>(index + element) : Tape<Scalar>::passive);
+    }
+
+    /* Retrieve the value of the element at the given position. */
+    Scalar value(size_t row, size_t column) const {
+      return (*vals)[position(row, column)];
+    }
+
+    /* Retrieve the values of all elements (in row-major order). */
+    std::span<const Scalar> values() const noexcept {
+      return *vals;
+    }
+
+    /* Retrieve the number of rows. */
+    size_t rows() const noexcept {
+      return height;
+    }
+
+    /* Retrieve the number of columns. */
+    size_t columns() const noexcept {
+      return width;
+    }
+
+  private:
+    Tape<Scalar> *tape; // Tape that the matrix was created on.
+    size_t height; // Number of rows.
+    size_t width; // Number of columns.
+    Index index; // Index of the node of the first element (the others follow it in row-major order).
+    std::shared_ptr<const std::vector<Scalar>> vals; // Values of the elements (shared with the kernels that need them).
+#ifndef NDEBUG
+    size_t generation; // Generation of the tape in which the nodes were recorded.
+#endif
+
+    /* Construct a matrix object for a particular tape given its shape, values and the index of its first node. */
+    Matrix(Tape<Scalar> &tape_, size_t rows_, size_t columns_, std::shared_ptr<const std::vector<Scalar>> values_, Index index_) noexcept : tape{&tape_}, height{rows_}, width{columns_}, index{index_}, vals(std::move(values_)) { // Constructor
+#ifndef NDEBUG
+      generation = tape_.generation;
+#endif
+    }
+
+    /* Retrieve the position of the element at the given row and column in row-major order. */
+    size_t position(size_t row, size_t column) const {
+      if (row >= height || column >= width) {
+        throw std::out_of_range("Position out of range for `AutoGrad::Matrix`");
+      }
+      return row * width + column;
+    }
+
+    /* Determine if the matrix is recorded on its tape, i.e. it is not a constant and recording is not paused. */
+    bool tracked() const noexcept {
+      return tape->recording() && index != Tape<Scalar>::passive;
+    }
+
+    /* Retrieve the shape and position on the tape of the matrix as an operand of a kernel. */
+    Kernels::Operand operand() const noexcept {
+      return Kernels::Operand{index, height, width};
+    }
+
+    /* Check that two matrices were created on the same tape and are still valid. */
+    static void check(const Matrix<Scalar> &matrix1, const Matrix<Scalar> &matrix2) {
+      if (matrix1.tape != matrix2.tape) {
+        throw std::invalid_argument("`AutoGrad::Matrix`s not from the same `AutoGrad::Tape`");
+      }
+      matrix1.tape->validate(matrix1);
+      matrix2.tape->validate(matrix2);
+    }
+
+    /* Record a kernel producing a matrix of the given shape and values on the given tape, unless none of its operands
+    are tracked (in which case the result is a constant). */
+    template<typename Kernel, typename... Arguments>
+    static Matrix<Scalar> record(bool tracked_, Tape<Scalar> &tape_, size_t rows_, size_t columns_, std::shared_ptr<const std::vector<Scalar>> values_, Arguments &&...arguments) {
+      if (!tracked_) {
+        return Matrix<Scalar>(tape_, rows_, columns_, std::move(values_), Tape<Scalar>::passive);
+      }
+      Index index_ = tape_.push_back(std::span<const Scalar>(*values_), std::make_unique<Kernel>(std::forward<Arguments>(arguments)...));
+      return Matrix<Scalar>(tape_, rows_, columns_, std::move(values_), index_);
+    }
+
+    /* Apply a unary operation (see `AutoGrad::Operations`) to each element. */
+    template<typename Operation>
+    static Matrix<Scalar> elementwise(const Matrix<Scalar> &matrix) {
+      matrix.tape->validate(matrix);
+      auto values_ = std::make_shared<std::vector<Scalar>>(matrix.vals->size());
+      for (size_t element = 0; element < values_->size(); element++) {
+        (*values_)[element] = Operation::value((*matrix.vals)[element]);
+      }
+      return record<Kernels::Elementwise<Scalar, Operation>>(matrix.tracked(), *matrix.tape, matrix.height, matrix.width, values_, matrix.operand(), matrix.vals, values_);
+    }
+
+    /* Apply a binary operation (see `AutoGrad::Operations`) to each pair of elements of two matrices, broadcasting an
+    operand with a single row or column along it. */
+    template<typename Operation>
+    static Matrix<Scalar> broadcast(const Matrix<Scalar> &matrix1, const Matrix<Scalar> &matrix2) {
+      check(matrix1, matrix2);
+      if ((matrix1.height != matrix2.height && matrix1.height != 1 && matrix2.height != 1) || (matrix1.width != matrix2.width && matrix1.width != 1 && matrix2.width != 1)) {
+        throw std::invalid_argument("`AutoGrad::Matrix`s of incompatible shapes");
+      }
+      size_t rows_ = std::max(matrix1.height, matrix2.height);
+      size_t columns_ = std::max(matrix1.width, matrix2.width);
+      Kernels::Operand left = matrix1.operand();
+      Kernels::Operand right = matrix2.operand();
+      auto values_ = std::make_shared<std::vector<Scalar>>(rows_ * columns_);
+      for (size_t row = 0; row < rows_; row++) {
+        for (size_t column = 0; column < columns_; column++) {
+          (*values_)[row * columns_ + column] = Operation::value((*matrix1.vals)[left.broadcast(row, column)], (*matrix2.vals)[right.broadcast(row, column)]);
+        }
+      }
+      return record<Kernels::Broadcast<Scalar, Operation>>(matrix1.tracked() || matrix2.tracked(), *matrix1.tape, rows_, columns_, values_, left, matrix1.vals, right, matrix2.vals, rows_, columns_, values_);
+    }
+
+    /* Apply a binary operation (see `AutoGrad::Operations`) to each element and a scalar, which is the right operand
+    unless `Reversed` is true. */
+    template<typename Operation, bool Reversed>
+    static Matrix<Scalar> constant(const Matrix<Scalar> &matrix, Scalar scalar) {
+      matrix.tape->validate(matrix);
+      auto values_ = std::make_shared<std::vector<Scalar>>(matrix.vals->size());
+      for (size_t element = 0; element < values_->size(); element++) {
+        if constexpr (Reversed) {
+          (*values_)[element] = Operation::value(scalar, (*matrix.vals)[element]);
+        } else {
+          (*values_)[element] = Operation::value((*matrix.vals)[element], scalar);
+        }
+      }
+      return record<Kernels::Constant<Scalar, Operation, Reversed>>(matrix.tracked(), *matrix.tape, matrix.height, matrix.width, values_, matrix.operand(), matrix.vals, scalar, values_);
+    }
+
+    /* Multiply two matrices. */
+    static Matrix<Scalar> product(const Matrix<Scalar> &matrix1, const Matrix<Scalar> &matrix2) {
+      check(matrix1, matrix2);
+      if (matrix1.width != matrix2.height) {
+        throw std::invalid_argument("`AutoGrad::Matrix`s of incompatible shapes");
+      }
+      auto values_ = std::make_shared<std::vector<Scalar>>(matrix1.height * matrix2.width, 0.0);
+      Kernels::multiply(matrix1.vals->data(), matrix2.vals->data(), values_->data(), matrix1.height, matrix1.width, matrix2.width);
+      return record<Kernels::Product<Scalar>>(matrix1.tracked() || matrix2.tracked(), *matrix1.tape, matrix1.height, matrix2.width, values_, matrix1.operand(), matrix1.vals, matrix2.operand(), matrix2.vals);
+    }
+
+    /* Transpose a matrix. */
+    static Matrix<Scalar> transposed(const Matrix<Scalar> &matrix) {
+      matrix.tape->validate(matrix);
+      auto values_ = std::make_shared<std::vector<Scalar>>(Kernels::transpose(matrix.vals->data(), matrix.height, matrix.width));
+      return record<Kernels::Transpose<Scalar>>(matrix.tracked(), *matrix.tape, matrix.width, matrix.height, values_, matrix.operand());
+    }
+
+    /* Add the elements of a matrix together along the rows and/or columns. */
+    static Matrix<Scalar> reduce(const Matrix<Scalar> &matrix, bool rows_, bool columns_) {
+      matrix.tape->validate(matrix);
+      Kernels::Operand result{0, rows_ ? 1 : matrix.height, columns_ ? 1 : matrix.width};
+      auto values_ = std::make_shared<std::vector<Scalar>>(result.rows * result.columns, 0.0);
+      for (size_t row = 0; row < matrix.height; row++) {
+        for (size_t column = 0; column < matrix.width; column++) {
+          (*values_)[result.broadcast(row, column)] += (*matrix.vals)[row * matrix.width + column];
+        }
+      }
+      return record<Kernels::Sum<Scalar>>(matrix.tracked(), *matrix.tape, result.rows, result.columns, values_, matrix.operand(), rows_, columns_);
+    }
+
+    /* Add all elements of a matrix together. */
+    static Variable<Scalar> total(const Matrix<Scalar> &matrix) {
+      Matrix<Scalar> result = reduce(matrix, true, true);
+      return result(0, 0);
+    }
+  };
+}
+
+
+#endif // AUTOGRAD_MATRIX_HPP
@@ -0,0 +1,136 @@
+#ifndef AUTOGRAD_OPCODE_HPP
+#define AUTOGRAD_OPCODE_HPP
+
+
+#include "operations.hpp"
+#include "utils.hpp"
+
+namespace AutoGrad {
+
+  /* Identifies the operation that produced a node of a tape (see `AutoGrad::Opcodes`), so that the node can be
+  evaluated again and its partial derivatives computed from the values of its operands (see `AutoGrad::Program`). */
+  using Opcode = std::uint8_t;
+}
+
+/* Contains the op codes of the operations recorded on a tape. Every differentiation rule in `AutoGrad::Operations`
+has an op code for each way in which it can be applied: a unary rule to a variable, and a binary rule to two variables,
+to a variable and a constant, or to a constant and a variable. Leaves and operations with a constant operand store the
+value of the leaf or the constant alongside the op code. */
+namespace AutoGrad::Opcodes {
+
+  /* Unary rules in the order of their op codes. */
+  using UnaryRules = std::tuple<Operations::Negation, Operations::SquareRoot, Operations::CubeRoot, Operations::Exponential, Operations::BinaryExponential, Operations::NaturalLogarithm, Operations::BinaryLogarithm, Operations::CommonLogarithm, Operations::Sine, Operations::Cosine, Operations::Tangent, Operations::Secant, Operations::Cosecant, Operations::Cotangent, Operations::InverseSine, Operations::InverseCosine, Operations::InverseTangent, Operations::InverseSecant, Operations::InverseCosecant, Operations::InverseCotangent, Operations::HyperbolicSine, Operations::HyperbolicCosine, Operations::HyperbolicTangent, Operations::HyperbolicSecant, Operations::HyperbolicCosecant, Operations::HyperbolicCotangent, Operations::InverseHyperbolicSine, Operations::InverseHyperbolicCosine, Operations::InverseHyperbolicTangent, Operations::InverseHyperbolicSecant, Operations::InverseHyperbolicCosecant, Operations::InverseHyperbolicCotangent, Operations::AbsoluteValue>;
+
+  /* Binary rules in the order of their op codes. */
+  using BinaryRules = std::tuple<Operations::Addition, Operations::Subtraction, Operations::Multiplication, Operations::Division, Operations::Power, Operations::Logarithm>;
+
+  /* The way in which an op code combines the operands of a node. */
+  enum class Kind {
+    Leaf, // A variable instantiated with a value (stored as its constant).
+    Copy, // A copy of a variable (with a partial derivative of one).
+    Opaque, // A fused expression or the result of a kernel, which cannot be evaluated again from its op code.
+    Unary, // A unary rule applied to a variable.
+    Binary, // A binary rule applied to two variables.
+    Left, // A binary rule applied to a variable and a constant.
+    Right, // A binary rule applied to a constant and a variable.
+  };
+
+  /* Position of a rule in a tuple of rules. */
+  template<typename Operation, typename Rules>
+  constexpr size_t position = []<typename... Rule>(std::tuple<Rule...> *) {
+    size_t index = 0;
+    ((std::is_same_v<Operation, Rule> ? false : (index++, true)) && ...);
+    return index;
+  }(static_cast<Rules *>(nullptr));
+
+  constexpr size_t unaries = std::tuple_size_v<UnaryRules>; // Number of unary rules.
+  constexpr size_t binaries = std::tuple_size_v<BinaryRules>; // Number of binary rules.
+
+  constexpr Opcode leaf = 0; // Op code of leaves.
+  constexpr Opcode copy = 1; // Op code of copies.
+  constexpr Opcode opaque = 2; // Op code of fused expressions and results of kernels.
+
+  /* Op code of a unary rule applied to a variable. */
+  template<typename Operation>
+  constexpr Opcode unary = static_cast<Opcode>(3 + position<Operation, UnaryRules>);
+
+  /* Op code of a binary rule applied to two variables. */
+  template<typename Operation>
+  constexpr Opcode binary = static_cast<Opcode>(3 + unaries + position<Operation, BinaryRules>);
+
+  /* Op code of a binary rule applied to a variable and a constant. */
+  template<typename Operation>
+  constexpr Opcode variableScalar = static_cast<Opcode>(binary<Operation> + binaries);
+
+  /* Op code of a binary rule applied to a constant and a variable. */
+  template<typename Operation>
+  constexpr Opcode scalarVariable = static_cast<Opcode>(binary<Operation> + 2 * binaries);
+
+  static_assert(3 + unaries + 3 * binaries <= std::numeric_limits<Opcode>::max(), "Too many rules for `AutoGrad::Opcode`");
+
+  /* Retrieve the way in which an op code combines the operands of a node. */
+  constexpr Kind kind(Opcode code) noexcept {
+    if (code < 3) {
+      return static_cast<Kind>(code);
+    } else if (code < 3 + unaries) {
+      return Kind::Unary;
+    } else if (code < 3 + unaries + binaries) {
+      return Kind::Binary;
+    }
+    return (code < 3 + unaries + 2 * binaries) ? Kind::Left : Kind::Right;
+  }
+
+  /* Determine if a node with the given op code stores a constant. */
+  constexpr bool constant(Opcode code) noexcept {
+    Kind kind_ = kind(code);
+    return kind_ == Kind::Leaf || kind_ == Kind::Left || kind_ == Kind::Right;
+  }
+
+  /* Compute the value of a unary rule (given its op code) applied to the operand. */
+  template<typename T>
+  T value(Opcode code, const T &x) {
+    static constexpr auto rules = []<typename... Rule>(std::tuple<Rule...> *) {
+      return std::array<T (*)(const T &), unaries>{&Rule::template value<T>...};
+    }(static_cast<UnaryRules *>(nullptr));
+    return rules[code - 3](x);
+  }
+
+  /* Compute the partial derivative of a unary rule (given its op code) with respect to the operand. */
+  template<typename T>
+  T derivative(Opcode code, const T &x, const T &value_) {
+    static constexpr auto rules = []<typename... Rule>(std::tuple<Rule...> *) {
+      return std::array<T (*)(const T &, const T &), unaries>{&Rule::template derivative<T>...};
+    }(static_cast<UnaryRules *>(nullptr));
+    return rules[code - 3](x, value_);
+  }
+
+  /* Compute the value of a binary rule (given any of its op codes) applied to the operands. */
+  template<typename T>
+  T value(Opcode code, const T &x, const T &y) {
+    static constexpr auto rules = []<typename... Rule>(std::tuple<Rule...> *) {
+      return std::array<T (*)(const T &, const T &), binaries>{&Rule::template value<T>...};
+    }(static_cast<BinaryRules *>(nullptr));
+    return rules[(code - 3 - unaries) % binaries](x, y);
+  }
+
+  /* Compute the partial derivative of a binary rule (given any of its op codes) with respect to the left operand. */
+  template<typename T>
+  T left(Opcode code, const T &x, const T &y, const T &value_) {
+    static constexpr auto rules = []<typename... Rule>(std::tuple<Rule...> *) {
+      return std::array<T (*)(const T &, const T &, const T &), binaries>{&Rule::template left<T>...};
+    }(static_cast<BinaryRules *>(nullptr));
+    return rules[(code - 3 - unaries) % binaries](x, y, value_);
+  }
+
+  /* Compute the partial derivative of a binary rule (given any of its op codes) with respect to the right operand. */
+  template<typename T>
+  T right(Opcode code, const T &x, const T &y, const T &value_) {
+    static constexpr auto rules = []<typename... Rule>(std::tuple<Rule...> *) {
+      return std::array<T (*)(const T &, const T &, const T &), binaries>{&Rule::template right<T>...};
+    }(static_cast<BinaryRules *>(nullptr));
+    return rules[(code - 3 - unaries) % binaries](x, y, value_);
+  }
+}
+
+
+#endif // AUTOGRAD_OPCODE_HPP
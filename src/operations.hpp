@@ -0,0 +1,714 @@
+
+#ifndef AUTOGRAD_OPERATIONS_HPP
+#define AUTOGRAD_OPERATIONS_HPP
+
+
+#include "fastmath.hpp"
+#include "utils.hpp"
+
+/* Contains the differentiation rules for the arithmetic operations and elementary mathematical functions implemented
+by AutoGrad. Each rule is a type with static functions that compute the value of the operation and its local partial
+derivatives, so that every mode of differentiation (`Variable`, `Dual`, ...) shares a single definition.
+
+The functions are templated on the type of the operands and call the mathematical functions unqualified (after a
+`using` declaration for the standard ones) so that they also apply to types such as `Dual` that overload them. Unary
+rules provide `value(x)` and `derivative(x, value)`; binary rules provide `value(x, y)` and the partial derivatives
+`left(x, y, value)` and `right(x, y, value)` with respect to `x` and `y`. The already computed value is passed to the
+derivatives so that they can reuse it instead of evaluating the function again. A unary rule whose value and derivative
+share most of their work (e.g. the sine and cosine of the same argument) also provides `evaluate(x)`, which computes
+both at once (see `AutoGrad::Operations::evaluate()`). */
+namespace AutoGrad::Operations {
+
+  // Arithmetic operations
+
+  /* Addition. */
+  struct Addition {
+    template<typename T>
+    static T value(const T &x, const T &y) {
+      return x + y;
+    }
+
+    template<typename T>
+    static T left(const T &, const T &, const T &) {
+      return T(1.0);
+    }
+
+    template<typename T>
+    static T right(const T &, const T &, const T &) {
+      return T(1.0);
+    }
+  };
+
+  /* Subtraction. */
+  struct Subtraction {
+    template<typename T>
+    static T value(const T &x, const T &y) {
+      return x - y;
+    }
+
+    template<typename T>
+    static T left(const T &, const T &, const T &) {
+      return T(1.0);
+    }
+
+    template<typename T>
+    static T right(const T &, const T &, const T &) {
+      return T(-1.0);
+    }
+  };
+
+  /* Multiplication. */
+  struct Multiplication {
+    template<typename T>
+    static T value(const T &x, const T &y) {
+      return x * y;
+    }
+
+    template<typename T>
+    static T left(const T &, const T &y, const T &) {
+      return y;
+    }
+
+    template<typename T>
+    static T right(const T &x, const T &, const T &) {
+      return x;
+    }
+  };
+
+  /* Division. */
+  struct Division {
+    template<typename T>
+    static T value(const T &x, const T &y) {
+      return x / y;
+    }
+
+    template<typename T>
+    static T left(const T &, const T &y, const T &) {
+      return 1.0 / y;
+    }
+
+    template<typename T>
+    static T right(const T &x, const T &y, const T &) {
+      return -x / (y * y);
+    }
+  };
+
+  /* Negation. */
+  struct Negation {
+    template<typename T>
+    static T value(const T &x) {
+      return -x;
+    }
+
+    template<typename T>
+    static T derivative(const T &, const T &) {
+      return T(-1.0);
+    }
+  };
+
+  // Exponential and logarithmic functions
+
+  /* Exponentiation (powers). */
+  struct Power {
+    template<typename T>
+    static T value(const T &x, const T &y) {
+      using std::pow;
+      return pow(x, y);
+    }
+
+    template<typename T>
+    static T left(const T &x, const T &y, const T &value_) {
+      using std::pow;
+      if constexpr (std::floating_point<T>) {
+        // `x^(y - 1) = x^y / x` unless the division could overflow or underflow.
+        if (std::isnormal(x) && std::isnormal(value_)) {
+          return y * (value_ / x);
+        }
+      }
+      return y * pow(x, y - 1.0);
+    }
+
+    template<typename T>
+    static T right(const T &x, const T &, const T &value_) {
+      using std::log;
+      return log(x) * value_;
+    }
+  };
+
+  /* Square root. */
+  struct SquareRoot {
+    template<typename T>
+    static T value(const T &x) {
+      using std::sqrt;
+      return sqrt(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &, const T &value_) {
+      return 0.5 / value_;
+    }
+  };
+
+  /* Cube root. */
+  struct CubeRoot {
+    template<typename T>
+    static T value(const T &x) {
+      using std::cbrt;
+      return cbrt(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &, const T &value_) {
+      return 1.0 / (3.0 * value_ * value_);
+    }
+  };
+
+  /* Exponential function. */
+  struct Exponential {
+    template<typename T>
+    static T value(const T &x) {
+#ifdef AUTOGRAD_FAST_MATH
+      if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+        return FastMath::exp(x);
+      }
+#endif
+      using std::exp;
+      return exp(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &, const T &value_) {
+      return value_;
+    }
+  };
+
+  /* Base-2 exponential function. */
+  struct BinaryExponential {
+    template<typename T>
+    static T value(const T &x) {
+      using std::exp2;
+      return exp2(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &, const T &value_) {
+      return value_ * std::numbers::ln2;
+    }
+  };
+
+  /* Natural logarithm. */
+  struct NaturalLogarithm {
+    template<typename T>
+    static T value(const T &x) {
+#ifdef AUTOGRAD_FAST_MATH
+      if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+        return FastMath::log(x);
+      }
+#endif
+      using std::log;
+      return log(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      return 1.0 / x;
+    }
+  };
+
+  /* Logarithm with a specified base (the second operand). */
+  struct Logarithm {
+    template<typename T>
+    static T value(const T &x, const T &y) {
+      using std::log;
+      return log(x) / log(y);
+    }
+
+    template<typename T>
+    static T left(const T &x, const T &y, const T &) {
+      using std::log;
+      return 1.0 / (x * log(y));
+    }
+
+    template<typename T>
+    static T right(const T &x, const T &y, const T &) {
+      using std::log;
+      return -log(x) / (y * log(y) * log(y));
+    }
+  };
+
+  /* Base-2 logarithm. */
+  struct BinaryLogarithm {
+    template<typename T>
+    static T value(const T &x) {
+      using std::log2;
+      return log2(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      return 1.0 / (x * std::numbers::ln2);
+    }
+  };
+
+  /* Base-10 logarithm. */
+  struct CommonLogarithm {
+    template<typename T>
+    static T value(const T &x) {
+      using std::log10;
+      return log10(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      return 1.0 / (x * std::numbers::ln10);
+    }
+  };
+
+  // Trigonometric functions
+
+  /* Sine. */
+  struct Sine {
+    template<typename T>
+    static T value(const T &x) {
+      using std::sin;
+      return sin(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::cos;
+      return cos(x);
+    }
+
+    template<typename T>
+    static std::pair<T, T> evaluate(const T &x) {
+      using std::sin, std::cos;
+      return {sin(x), cos(x)}; // Compilers combine these into a single call to `sincos`.
+    }
+  };
+
+  /* Cosine. */
+  struct Cosine {
+    template<typename T>
+    static T value(const T &x) {
+      using std::cos;
+      return cos(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::sin;
+      return -sin(x);
+    }
+
+    template<typename T>
+    static std::pair<T, T> evaluate(const T &x) {
+      using std::sin, std::cos;
+      return {cos(x), -sin(x)};
+    }
+  };
+
+  /* Tangent. */
+  struct Tangent {
+    template<typename T>
+    static T value(const T &x) {
+      using std::tan;
+      return tan(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &, const T &value_) {
+      return 1.0 + value_ * value_;
+    }
+  };
+
+  /* Secant. */
+  struct Secant {
+    template<typename T>
+    static T value(const T &x) {
+      using std::cos;
+      return 1.0 / cos(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &value_) {
+      using std::tan;
+      return tan(x) * value_;
+    }
+
+    template<typename T>
+    static std::pair<T, T> evaluate(const T &x) {
+      using std::sin, std::cos;
+      T value_ = 1.0 / cos(x);
+      return {value_, sin(x) * value_ * value_};
+    }
+  };
+
+  /* Cosecant. */
+  struct Cosecant {
+    template<typename T>
+    static T value(const T &x) {
+      using std::sin;
+      return 1.0 / sin(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &value_) {
+      using std::tan;
+      return -value_ / tan(x);
+    }
+
+    template<typename T>
+    static std::pair<T, T> evaluate(const T &x) {
+      using std::sin, std::cos;
+      T value_ = 1.0 / sin(x);
+      return {value_, -cos(x) * value_ * value_};
+    }
+  };
+
+  /* Cotangent. */
+  struct Cotangent {
+    template<typename T>
+    static T value(const T &x) {
+      using std::tan;
+      return 1.0 / tan(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &, const T &value_) {
+      return -1.0 - value_ * value_;
+    }
+  };
+
+  /* Inverse sine. */
+  struct InverseSine {
+    template<typename T>
+    static T value(const T &x) {
+      using std::asin;
+      return asin(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::sqrt;
+      return 1.0 / sqrt(1.0 - x * x);
+    }
+  };
+
+  /* Inverse cosine. */
+  struct InverseCosine {
+    template<typename T>
+    static T value(const T &x) {
+      using std::acos;
+      return acos(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::sqrt;
+      return -1.0 / sqrt(1.0 - x * x);
+    }
+  };
+
+  /* Inverse tangent. */
+  struct InverseTangent {
+    template<typename T>
+    static T value(const T &x) {
+      using std::atan;
+      return atan(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      return 1.0 / (1.0 + x * x);
+    }
+  };
+
+  /* Inverse secant. */
+  struct InverseSecant {
+    template<typename T>
+    static T value(const T &x) {
+      using std::acos;
+      return acos(1.0 / x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::abs, std::sqrt;
+      return 1.0 / (abs(x) * sqrt(x * x - 1.0));
+    }
+  };
+
+  /* Inverse cosecant. */
+  struct InverseCosecant {
+    template<typename T>
+    static T value(const T &x) {
+      using std::asin;
+      return asin(1.0 / x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::abs, std::sqrt;
+      return -1.0 / (abs(x) * sqrt(x * x - 1.0));
+    }
+  };
+
+  /* Inverse cotangent (with range (0, pi)). */
+  struct InverseCotangent {
+    template<typename T>
+    static T value(const T &x) {
+      using std::atan;
+      return std::numbers::pi / 2.0 - atan(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      return -1.0 / (1.0 + x * x);
+    }
+  };
+
+  // Hyperbolic trigonometric functions
+
+  /* Hyperbolic sine. */
+  struct HyperbolicSine {
+    template<typename T>
+    static T value(const T &x) {
+      using std::sinh;
+      return sinh(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::cosh;
+      return cosh(x);
+    }
+  };
+
+  /* Hyperbolic cosine. */
+  struct HyperbolicCosine {
+    template<typename T>
+    static T value(const T &x) {
+      using std::cosh;
+      return cosh(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::sinh;
+      return sinh(x);
+    }
+  };
+
+  /* Hyperbolic tangent. */
+  struct HyperbolicTangent {
+    template<typename T>
+    static T value(const T &x) {
+#ifdef AUTOGRAD_FAST_MATH
+      if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+        return FastMath::tanh(x);
+      }
+#endif
+      using std::tanh;
+      return tanh(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &, const T &value_) {
+      return 1.0 - value_ * value_;
+    }
+  };
+
+  /* Hyperbolic secant. */
+  struct HyperbolicSecant {
+    template<typename T>
+    static T value(const T &x) {
+      using std::cosh;
+      return 1.0 / cosh(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &value_) {
+      using std::tanh;
+      return -tanh(x) * value_;
+    }
+
+    template<typename T>
+    requires std::floating_point<T> // Other scalars (e.g. `Dual`) lack `expm1()` and `copysign()` and use the above.
+    static std::pair<T, T> evaluate(const T &x) {
+      using std::abs, std::copysign, std::exp, std::expm1;
+      // Both follow from `e = exp(-|x|)`, which does not overflow, and `1 - e * e`, which is computed from `expm1()`
+      // near zero so that `tanh(x)` (and so the derivative) stays accurate there.
+      T e, difference;
+      if (abs(x) < 1.0) {
+        T u = expm1(-abs(x));
+        e = 1.0 + u;
+        difference = -u * (2.0 + u);
+      } else {
+        e = exp(-abs(x));
+        difference = 1.0 - e * e;
+      }
+      T sum = 1.0 + e * e;
+      T value_ = 2.0 * e / sum;
+      return {value_, -copysign(difference / sum, x) * value_};
+    }
+  };
+
+  /* Hyperbolic cosecant. */
+  struct HyperbolicCosecant {
+    template<typename T>
+    static T value(const T &x) {
+      using std::sinh;
+      return 1.0 / sinh(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &, const T &value_) {
+      using std::abs, std::sqrt;
+      return -abs(value_) * sqrt(value_ * value_ + 1.0);
+    }
+  };
+
+  /* Hyperbolic cotangent. */
+  struct HyperbolicCotangent {
+    template<typename T>
+    static T value(const T &x) {
+      using std::tanh;
+      return 1.0 / tanh(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::sinh;
+      return -1.0 / (sinh(x) * sinh(x));
+    }
+  };
+
+  /* Inverse hyperbolic sine. */
+  struct InverseHyperbolicSine {
+    template<typename T>
+    static T value(const T &x) {
+      using std::asinh;
+      return asinh(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::sqrt;
+      return 1.0 / sqrt(x * x + 1.0);
+    }
+  };
+
+  /* Inverse hyperbolic cosine. */
+  struct InverseHyperbolicCosine {
+    template<typename T>
+    static T value(const T &x) {
+      using std::acosh;
+      return acosh(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::sqrt;
+      return 1.0 / sqrt(x * x - 1.0);
+    }
+  };
+
+  /* Inverse hyperbolic tangent. */
+  struct InverseHyperbolicTangent {
+    template<typename T>
+    static T value(const T &x) {
+      using std::atanh;
+      return atanh(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      return 1.0 / (1.0 - x * x);
+    }
+  };
+
+  /* Inverse hyperbolic secant. */
+  struct InverseHyperbolicSecant {
+    template<typename T>
+    static T value(const T &x) {
+      using std::acosh;
+      return acosh(1.0 / x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::abs, std::sqrt;
+      return -1.0 / (abs(x) * sqrt(1.0 - x * x));
+    }
+  };
+
+  /* Inverse hyperbolic cosecant. */
+  struct InverseHyperbolicCosecant {
+    template<typename T>
+    static T value(const T &x) {
+      using std::asinh;
+      return asinh(1.0 / x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      using std::abs, std::sqrt;
+      return -1.0 / (abs(x) * sqrt(1.0 + x * x));
+    }
+  };
+
+  /* Inverse hyperbolic cotangent. */
+  struct InverseHyperbolicCotangent {
+    template<typename T>
+    static T value(const T &x) {
+      using std::atanh;
+      return atanh(1.0 / x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &) {
+      return 1.0 / (1.0 - x * x);
+    }
+  };
+
+  /* Absolute value. */
+  struct AbsoluteValue {
+    template<typename T>
+    static T value(const T &x) {
+      using std::abs;
+      return abs(x);
+    }
+
+    template<typename T>
+    static T derivative(const T &x, const T &value_) {
+      return value_ / x;
+    }
+  };
+
+  /* Compute the value of a unary rule together with its derivative, with the rule's `evaluate()` if it has one. */
+  template<typename Rule, typename T>
+  std::pair<T, T> evaluate(const T &x) {
+    if constexpr (requires { Rule::template evaluate<T>(x); }) {
+      return Rule::template evaluate<T>(x);
+    } else {
+      T value_ = Rule::template value<T>(x);
+      return {value_, Rule::template derivative<T>(x, value_)};
+    }
+  }
+
+  /* Compute the values of a unary rule and its derivatives at each of the given arguments. The loop has no branches
+  or calls other than those of the rule, so it is vectorized for rules whose functions the compiler can vectorize (e.g.
+  with `AUTOGRAD_FAST_MATH`). */
+  template<typename Rule, typename T>
+  void evaluate(std::span<const T> x, std::span<T> values, std::span<T> derivatives) {
+    for (size_t i = 0; i < x.size(); i++) {
+      auto [value_, derivative] = evaluate<Rule>(x[i]);
+      values[i] = value_;
+      derivatives[i] = derivative;
+    }
+  }
+}
+
+
+#endif // AUTOGRAD_OPERATIONS_HPP
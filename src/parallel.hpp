@@ -0,0 +1,138 @@
+
+#ifndef AUTOGRAD_PARALLEL_HPP
+#define AUTOGRAD_PARALLEL_HPP
+
+
+#include "gradient.hpp"
+#include "tape.hpp"
+#include "utils.hpp"
+#include "variable.hpp"
+
+namespace AutoGrad {
+
+  /* Evaluates a function of a set of shared parameters for every sample of a batch on several threads and sums the
+  gradients with respect to the parameters (e.g. the gradient of the loss over a minibatch). Each thread records onto
+  its own tape, on which the parameters are declared again as leaves (or as constants for those that are constants, see
+  `Tape::constant()`), so that no synchronization is needed while recording or sweeping. The tapes are rewound rather
+  than destroyed between samples and between calls, so they stop allocating once they have grown to the size of a
+  single sample. */
+  template<FloatingPoint Scalar>
+  class ParallelTape {
+  public:
+    /* Construct a new parallel tape object that uses the given number of threads (including the calling one). */
+    explicit ParallelTape(size_t threads = std::max(std::thread::hardware_concurrency(), 1u)) : workers(std::max(threads, static_cast<size_t>(1))) {} // Constructor
+
+    /* Compute the sum over all samples in `[0, samples)` of the given function and its gradient with respect to the
+    given parameters. The function is called as `function(tape, parameters, sample)` where `tape` is the tape of the
+    calling thread, `parameters` are the parameters declared on that tape (in the same order) and `sample` is the index
+    of the sample, and it must return a variable on `tape`. It is called concurrently from several threads, so it must
+    not modify shared state. Samples are split into contiguous ranges, one per thread, so that the result does not
+    depend on the scheduling of the threads. */
+    template<typename Function>
+    Gradient<Scalar> gradient(std::span<const Variable<Scalar>> parameters, size_t samples, Function function) {
+      if (parameters.empty()) {
+        throw std::invalid_argument("No parameters given to `AutoGrad::ParallelTape`");
+      }
+      Tape<Scalar> &tape = parameters.front().tape;
+      std::vector<Scalar> values;
+      std::vector<Index> indices;
+      std::vector<bool> active;
+      for (const Variable<Scalar> &parameter : parameters) {
+        if (&tape != &parameter.tape) {
+          throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
+        }
+        tape.validate(parameter);
+        values.push_back(parameter.val);
+        indices.push_back(parameter.index);
+        active.push_back(tape.tracked(parameter));
+      }
+      size_t threads = std::clamp(samples, static_cast<size_t>(1), workers.size());
+      {
+        std::vector<std::jthread> pool;
+        for (size_t thread = 1; thread < threads; thread++) {
+          pool.emplace_back([&, thread] {
+            run(workers[thread], values, active, samples * thread / threads, samples * (thread + 1) / threads, function);
+          });
+        }
+        run(workers[0], values, active, 0, samples / threads, function);
+      }
+      // The per-thread sums are reduced by the calling thread, one contiguous vector at a time.
+      std::vector<Scalar> gradients(parameters.size(), 0.0);
+      total = 0.0;
+      for (size_t thread = 0; thread < threads; thread++) {
+        Worker &worker = workers[thread];
+        if (worker.error) {
+          std::rethrow_exception(std::exchange(worker.error, nullptr));
+        }
+        for (size_t parameter = 0; parameter < gradients.size(); parameter++) {
+          gradients[parameter] += worker.partials[parameter];
+        }
+        total += worker.value;
+      }
+      return Gradient<Scalar>(tape, std::move(gradients), std::move(indices));
+    }
+
+    /* Retrieve the sum of the function values over all samples from the last call to `gradient()`. */
+    Scalar value() const noexcept {
+      return total;
+    }
+
+  private:
+    /* State owned by a single thread. */
+    struct Worker {
+      Tape<Scalar> tape; // Tape that the samples are recorded on.
+      std::vector<Variable<Scalar>> parameters; // Parameters declared on the tape.
+      std::vector<Scalar> adjoints; // Adjoints of the nodes of a single sample.
+      std::vector<Scalar> partials; // Sum of the gradients of the samples.
+      Scalar value; // Sum of the function values of the samples.
+      std::exception_ptr error; // Exception thrown while evaluating the samples.
+    };
+
+    std::vector<Worker> workers; // State of each thread.
+    Scalar total = 0.0; // Sum of the function values from the last call to `gradient()`.
+
+    /* Evaluate the samples in `[begin, end)` on a single thread and accumulate their gradients (which stay zero for the
+    parameters that are not active). */
+    template<typename Function>
+    static void run(Worker &worker, const std::vector<Scalar> &values, const std::vector<bool> &active, size_t begin, size_t end, Function &function) {
+      try {
+        Tape<Scalar> &tape = worker.tape;
+        tape.clear();
+        worker.parameters.clear();
+        for (size_t parameter = 0; parameter < values.size(); parameter++) {
+          worker.parameters.push_back(active[parameter] ? tape.variable(values[parameter]) : tape.constant(values[parameter]));
+        }
+        Index mark = tape.mark();
+        worker.partials.assign(values.size(), 0.0);
+        worker.value = 0.0;
+        for (size_t sample = begin; sample < end; sample++) {
+          Variable<Scalar> output = function(tape, std::span<const Variable<Scalar>>(worker.parameters), sample);
+          if (&output.tape != &tape) {
+            throw std::invalid_argument("`AutoGrad::Variable` not from the `AutoGrad::Tape` of the thread");
+          }
+          tape.validate(output);
+          worker.value += output.val;
+          if (output.index == Tape<Scalar>::passive) {
+            tape.rewind(mark);
+            continue;
+          }
+          worker.adjoints.assign(static_cast<size_t>(output.index) + 1, 0.0);
+          worker.adjoints[output.index] = 1.0;
+          tape.sweep(worker.adjoints, output.index);
+          for (size_t parameter = 0; parameter < values.size(); parameter++) {
+            Index index = worker.parameters[parameter].index;
+            if (index != Tape<Scalar>::passive && index <= output.index) {
+              worker.partials[parameter] += worker.adjoints[index];
+            }
+          }
+          tape.rewind(mark);
+        }
+      } catch (...) {
+        worker.error = std::current_exception();
+      }
+    }
+  };
+}
+
+
+#endif // AUTOGRAD_PARALLEL_HPP
@@ -0,0 +1,143 @@
+#ifndef AUTOGRAD_PROGRAM_HPP
+#define AUTOGRAD_PROGRAM_HPP
+
+
+#include "opcode.hpp"
+#include "utils.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class Tape; // Forward declaration
+
+  /* An immutable copy of the computational graph of an output variable (see `Tape::compile()`) that can be evaluated
+  again with new values of its input variables and differentiated without recording anything. Each node is stored as
+  its op code (see `AutoGrad::Opcodes`) and dependencies, so evaluating the program interprets the op codes in order
+  and computing the gradient recomputes the partial derivatives from the values of the operands in the reverse sweep.
+  Nodes that the output does not depend on are left out when compiling. All buffers are allocated once when compiling,
+  so evaluating the program and computing its gradient do not allocate memory. A program is not thread-safe since it
+  keeps the values and adjoints of the last evaluation, but it can be copied (e.g. once per thread). */
+  template<FloatingPoint Scalar>
+  class Program {
+    friend class Tape<Scalar>;
+
+  public:
+    /* Evaluate the program with the given values of the input variables (in the order in which they were passed to
+    `Tape::compile()`) and return the value of the output. */
+    Scalar evaluate(std::span<const Scalar> inputs_) {
+      if (inputs_.size() != slots.size()) {
+        throw std::invalid_argument("Number of values does not match the number of inputs of the `AutoGrad::Program`");
+      }
+      for (size_t input = 0; input < inputs_.size(); input++) {
+        if (slots[input] != none) {
+          constants[slots[input]] = inputs_[input];
+        }
+      }
+      run();
+      return values.back();
+    }
+
+    /* Compute the partial derivatives of the output with respect to the input variables (in the order in which they
+    were passed to `Tape::compile()`) at the values of the last evaluation. The result refers to a buffer of the program
+    that is overwritten by the next call. */
+    std::span<const Scalar> gradient() {
+      std::fill(adjoints.begin(), adjoints.end(), 0.0);
+      adjoints.back() = 1.0;
+      size_t constant = constants.size();
+      for (size_t i = codes.size(); i-- > 0;) {
+        Opcode code = codes[i];
+        const Index *operands = dependencies.data() + offsets[i];
+        Scalar adjoint = adjoints[i];
+        switch (Opcodes::kind(code)) {
+          case Opcodes::Kind::Leaf:
+            constant--;
+            break;
+          case Opcodes::Kind::Copy:
+            adjoints[operands[0]] += adjoint;
+            break;
+          case Opcodes::Kind::Unary:
+            adjoints[operands[0]] += Opcodes::derivative(code, values[operands[0]], values[i]) * adjoint;
+            break;
+          case Opcodes::Kind::Binary:
+            adjoints[operands[0]] += Opcodes::left(code, values[operands[0]], values[operands[1]], values[i]) * adjoint;
+            adjoints[operands[1]] += Opcodes::right(code, values[operands[0]], values[operands[1]], values[i]) * adjoint;
+            break;
+          case Opcodes::Kind::Left:
+            constant--;
+            adjoints[operands[0]] += Opcodes::left(code, values[operands[0]], constants[constant], values[i]) * adjoint;
+            break;
+          case Opcodes::Kind::Right:
+            constant--;
+            adjoints[operands[0]] += Opcodes::right(code, constants[constant], values[operands[0]], values[i]) * adjoint;
+            break;
+          case Opcodes::Kind::Opaque:
+            break;
+        }
+      }
+      for (size_t input = 0; input < inputs.size(); input++) {
+        gradients[input] = (inputs[input] != none) ? adjoints[inputs[input]] : 0.0;
+      }
+      return gradients;
+    }
+
+    /* Retrieve the value of the output at the last evaluation. */
+    Scalar value() const noexcept {
+      return values.back();
+    }
+
+    /* Retrieve the number of nodes in the program. */
+    size_t size() const noexcept {
+      return codes.size();
+    }
+
+  private:
+    static constexpr size_t none = std::numeric_limits<size_t>::max(); // Marks an input that the output does not depend on.
+
+    // Nodes are stored in compressed sparse row form as in `AutoGrad::Tape` (with a final end position).
+    std::vector<Opcode> codes; // Op code of each node.
+    std::vector<Index> offsets; // Position of each node's first dependency.
+    std::vector<Index> dependencies; // Index of the parent node along each edge.
+    std::vector<Scalar> constants; // Constants of the nodes that store one, in order.
+    std::vector<size_t> inputs; // Index of each input variable (or `none` if the output does not depend on it).
+    std::vector<size_t> slots; // Position of the constant that stores the value of each input variable (or `none`).
+    std::vector<Scalar> values; // Value of each node at the last evaluation.
+    std::vector<Scalar> adjoints; // Adjoint of each node at the last computation of the gradient.
+    std::vector<Scalar> gradients; // Partial derivative with respect to each input variable.
+
+    /* Construct an empty program object (which is filled in by `Tape::compile()`). */
+    Program() noexcept = default; // Default constructor
+
+    /* Compute the value of every node from the constants, interpreting the op codes in order. */
+    void run() {
+      size_t constant = 0;
+      for (size_t i = 0; i < codes.size(); i++) {
+        Opcode code = codes[i];
+        const Index *operands = dependencies.data() + offsets[i];
+        switch (Opcodes::kind(code)) {
+          case Opcodes::Kind::Leaf:
+            values[i] = constants[constant++];
+            break;
+          case Opcodes::Kind::Copy:
+            values[i] = values[operands[0]];
+            break;
+          case Opcodes::Kind::Unary:
+            values[i] = Opcodes::value(code, values[operands[0]]);
+            break;
+          case Opcodes::Kind::Binary:
+            values[i] = Opcodes::value(code, values[operands[0]], values[operands[1]]);
+            break;
+          case Opcodes::Kind::Left:
+            values[i] = Opcodes::value(code, values[operands[0]], constants[constant++]);
+            break;
+          case Opcodes::Kind::Right:
+            values[i] = Opcodes::value(code, constants[constant++], values[operands[0]]);
+            break;
+          case Opcodes::Kind::Opaque:
+            break;
+        }
+      }
+    }
+  };
+}
+
+
+#endif // AUTOGRAD_PROGRAM_HPP
@@ -0,0 +1,239 @@
+#ifndef AUTOGRAD_SAVED_HPP
+#define AUTOGRAD_SAVED_HPP
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "opcode.hpp"
+#include "utils.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class Tape; // Forward declaration
+
+  /* A computational graph saved to a file by `Tape::save()` and loaded back (on POSIX systems), e.g. to record on one
+  machine and compute gradients later on another. The file is mapped into memory, so loading it does not copy the graph
+  unless it was saved on a machine with the opposite byte order, in which case it is converted. It holds the edges of
+  every node (with their partial derivatives already computed), the op code of every node and the values of the leaves
+  and constant operands, together with the output and input variables given when saving. */
+  template<FloatingPoint Scalar>
+  class SavedTape {
+    friend class Tape<Scalar>;
+
+  public:
+    /* Load the computational graph saved to the file with the given path. */
+    explicit SavedTape(const std::string &path) { // Constructor
+      int descriptor = ::open(path.c_str(), O_RDONLY);
+      if (descriptor < 0) {
+        throw std::system_error(errno, std::generic_category(), "Cannot open the file of an `AutoGrad::SavedTape`");
+      }
+      struct stat status;
+      if (::fstat(descriptor, &status) != 0) {
+        int error = errno;
+        ::close(descriptor);
+        throw std::system_error(error, std::generic_category(), "Cannot read the file of an `AutoGrad::SavedTape`");
+      }
+      length = static_cast<size_t>(status.st_size);
+      if (length < sizeof(Header)) {
+        ::close(descriptor);
+        throw std::invalid_argument("File of an `AutoGrad::SavedTape` is truncated");
+      }
+      void *address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+      ::close(descriptor);
+      if (address == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "Cannot map the file of an `AutoGrad::SavedTape`");
+      }
+      mapping = static_cast<const std::byte *>(address);
+      try {
+        load();
+      } catch (...) {
+        ::munmap(const_cast<std::byte *>(mapping), length);
+        throw;
+      }
+    }
+
+    // Disallow copy semantics
+    // The mapping is owned by a single object.
+    SavedTape(const SavedTape<Scalar> &tape) = delete; // Copy constructor
+    SavedTape<Scalar> &operator=(const SavedTape<Scalar> &tape) = delete; // Copy assignment operator
+
+    /* Destroy the saved tape object, unmapping the file. */
+    ~SavedTape() { // Destructor
+      ::munmap(const_cast<std::byte *>(mapping), length);
+    }
+
+    /* Retrieve the number of nodes in the computational graph. */
+    size_t size() const noexcept {
+      return offsets.size();
+    }
+
+    /* Retrieve the values of the output variables (in the order in which they were passed to `Tape::save()`). */
+    std::span<const Scalar> outputs() const noexcept {
+      return outputValues;
+    }
+
+    /* Retrieve the values of the input variables (in the order in which they were passed to `Tape::save()`). */
+    std::span<const Scalar> inputs() const noexcept {
+      return inputValues;
+    }
+
+    /* Compute the partial derivatives of the output at the given position with respect to the inputs, sweeping the
+    saved graph backwards in the same way as `Tape::sweep()`. */
+    std::vector<Scalar> gradient(size_t output) const {
+      if (output >= outputIndices.size()) {
+        throw std::out_of_range("Output not saved with the `AutoGrad::SavedTape`");
+      }
+      Index start = outputIndices[output];
+      std::vector<Scalar> gradients(inputIndices.size(), 0.0);
+      if (start == std::numeric_limits<Index>::max()) {
+        return gradients;
+      }
+      std::vector<Scalar> adjoints(static_cast<size_t>(start) + 1, 0.0);
+      adjoints[start] = 1.0;
+      size_t end = (static_cast<size_t>(start) + 1 < offsets.size()) ? offsets[start + 1] : dependencies.size();
+      for (size_t i = start; i > 0; i--) {
+        size_t begin = offsets[i];
+        Scalar adjoint = adjoints[i];
+        for (size_t edge = begin; edge < end; edge++) {
+          adjoints[dependencies[edge]] += weights[edge] * adjoint;
+        }
+        end = begin;
+      }
+      for (size_t input = 0; input < inputIndices.size(); input++) {
+        gradients[input] = (inputIndices[input] <= start) ? adjoints[inputIndices[input]] : 0.0;
+      }
+      return gradients;
+    }
+
+  private:
+    static constexpr std::uint64_t magic = 0x444152474F545541; // "AUTOGRAD" in little-endian byte order.
+    static constexpr std::uint64_t version = 1; // Version of the file format written by `Tape::save()`.
+    static constexpr std::uint64_t order = 0x0102030405060708; // Reads differently on a machine with another byte order.
+    static constexpr size_t alignment = 64; // Alignment of each section of the file.
+
+    /* The start of the file, which is followed by the offsets, dependencies, weights, op codes, constants, output
+    indices and values and input indices and values (each aligned to `alignment` bytes and stored in the byte order of
+    the machine that saved it). */
+    struct Header {
+      std::uint64_t magic; // Identifies the file format.
+      std::uint64_t version; // Version of the file format.
+      std::uint64_t order; // Byte order marker.
+      std::uint64_t scalar; // Size of a scalar in bytes.
+      std::uint64_t index; // Size of an index in bytes.
+      std::uint64_t nodes; // Number of nodes.
+      std::uint64_t edges; // Number of edges.
+      std::uint64_t constants; // Number of constants.
+      std::uint64_t outputs; // Number of output variables.
+      std::uint64_t inputs; // Number of input variables.
+    };
+
+    const std::byte *mapping = nullptr; // Start of the mapping of the file.
+    size_t length = 0; // Length of the file in bytes.
+    std::span<const Index> offsets; // Position of each node's first edge.
+    std::span<const Index> dependencies; // Index of the parent node along each edge.
+    std::span<const Scalar> weights; // Partial derivative along each edge.
+    std::span<const Opcode> codes; // Op code of each node.
+    std::span<const Scalar> constants; // Value of each leaf and constant operand, in the order of their nodes.
+    std::span<const Index> outputIndices; // Index of each output variable.
+    std::span<const Scalar> outputValues; // Value of each output variable.
+    std::span<const Index> inputIndices; // Index of each input variable.
+    std::span<const Scalar> inputValues; // Value of each input variable.
+    std::vector<std::byte> converted; // Sections converted to the byte order of this machine (if needed).
+
+    /* Retrieve a value with its bytes in reverse order. */
+    template<typename T>
+    static T swapped(T value) {
+      auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+      std::reverse(bytes.begin(), bytes.end());
+      return std::bit_cast<T>(bytes);
+    }
+
+    /* Round a position in the file up to the alignment of a section. */
+    static size_t align(size_t position) {
+      return (position + alignment - 1) / alignment * alignment;
+    }
+
+    /* Check the header and point each section at the mapping (or at a converted copy). */
+    void load() {
+      Header header;
+      std::memcpy(&header, mapping, sizeof(Header));
+      bool swap = header.order != order;
+      if (swap) {
+        for (std::uint64_t *field : {&header.magic, &header.version, &header.order, &header.scalar, &header.index, &header.nodes, &header.edges, &header.constants, &header.outputs, &header.inputs}) {
+          *field = swapped(*field);
+        }
+      }
+      if (header.magic != magic || header.order != order) {
+        throw std::invalid_argument("File of an `AutoGrad::SavedTape` is not a saved tape");
+      } else if (header.version > version) {
+        throw std::invalid_argument("File of an `AutoGrad::SavedTape` has a newer version of the format");
+      } else if (header.scalar != sizeof(Scalar) || header.index != sizeof(Index)) {
+        throw std::invalid_argument("File of an `AutoGrad::SavedTape` was saved with a different scalar or index type");
+      }
+      size_t counts[] = {header.nodes, header.edges, header.edges, header.nodes, header.constants, header.outputs, header.outputs, header.inputs, header.inputs};
+      size_t sizes[] = {sizeof(Index), sizeof(Index), sizeof(Scalar), sizeof(Opcode), sizeof(Scalar), sizeof(Index), sizeof(Scalar), sizeof(Index), sizeof(Scalar)};
+      size_t positions[std::size(counts)];
+      size_t position = sizeof(Header);
+      for (size_t section = 0; section < std::size(counts); section++) {
+        position = align(position);
+        if (counts[section] > (length - std::min(length, position)) / sizes[section]) {
+          throw std::invalid_argument("File of an `AutoGrad::SavedTape` is truncated");
+        }
+        positions[section] = position;
+        position += counts[section] * sizes[section];
+      }
+      const std::byte *base = mapping;
+      if (swap) {
+        converted.assign(mapping, mapping + position);
+        base = converted.data();
+        for (size_t section = 0; section < std::size(counts); section++) {
+          std::byte *data = converted.data() + positions[section];
+          for (size_t element = 0; element < counts[section]; element++) {
+            std::reverse(data + element * sizes[section], data + (element + 1) * sizes[section]);
+          }
+        }
+      }
+      auto view = [&]<typename T>(size_t section, T *) {
+        return std::span<const T>(reinterpret_cast<const T *>(base + positions[section]), counts[section]);
+      };
+      offsets = view(0, static_cast<Index *>(nullptr));
+      dependencies = view(1, static_cast<Index *>(nullptr));
+      weights = view(2, static_cast<Scalar *>(nullptr));
+      codes = view(3, static_cast<Opcode *>(nullptr));
+      constants = view(4, static_cast<Scalar *>(nullptr));
+      outputIndices = view(5, static_cast<Index *>(nullptr));
+      outputValues = view(6, static_cast<Scalar *>(nullptr));
+      inputIndices = view(7, static_cast<Index *>(nullptr));
+      inputValues = view(8, static_cast<Scalar *>(nullptr));
+      // Every edge must belong to a node (the edges of the first node start at zero) and point to an earlier node, so
+      // that `gradient()` only ever reaches adjoints below the start of the sweep.
+      if (offsets.empty() ? !dependencies.empty() : offsets[0] != 0) {
+        throw std::invalid_argument("File of an `AutoGrad::SavedTape` is corrupted");
+      }
+      for (size_t i = 0; i < offsets.size(); i++) {
+        size_t end = (i + 1 < offsets.size()) ? offsets[i + 1] : dependencies.size();
+        if (offsets[i] > end || end > dependencies.size()) {
+          throw std::invalid_argument("File of an `AutoGrad::SavedTape` is corrupted");
+        }
+        for (size_t edge = offsets[i]; edge < end; edge++) {
+          if (dependencies[edge] >= i) {
+            throw std::invalid_argument("File of an `AutoGrad::SavedTape` is corrupted");
+          }
+        }
+      }
+      for (std::span<const Index> variables : {outputIndices, inputIndices}) {
+        for (Index index : variables) {
+          if (index >= offsets.size() && index != std::numeric_limits<Index>::max()) {
+            throw std::invalid_argument("File of an `AutoGrad::SavedTape` is corrupted");
+          }
+        }
+      }
+    }
+  };
+}
+
+
+#endif // AUTOGRAD_SAVED_HPP
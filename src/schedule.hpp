@@ -0,0 +1,118 @@
+
+#ifndef AUTOGRAD_SCHEDULE_HPP
+#define AUTOGRAD_SCHEDULE_HPP
+
+
+#include "utils.hpp"
+
+namespace AutoGrad {
+  template<FloatingPoint Scalar>
+  class Tape; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Variable; // Forward declaration
+
+  /* A schedule for sweeping a tape backwards on several threads (see `Variable::gradient(schedule, threads)`). Each
+  node is assigned a level one greater than the highest level of its dependencies (leaves are at level zero), so the
+  nodes within a level are independent of each other and a level can be swept once every higher level has been. Levels
+  with enough nodes are swept in parallel; runs of consecutive narrower levels are merged into segments that are swept
+  by a single thread, so that the threads only synchronize between segments. A schedule only describes the tape as it
+  was when the schedule was created and must be created again after recording more nodes or rewinding the tape. */
+  template<FloatingPoint Scalar>
+  class Schedule {
+    friend class Tape<Scalar>;
+    friend class Variable<Scalar>;
+
+  public:
+
+    /* Retrieve the number of levels (the length of the longest path through the computational graph). */
+    size_t levels() const noexcept {
+      return depth;
+    }
+
+    /* Retrieve the number of segments that are swept one after another. */
+    size_t segments() const noexcept {
+      return ranges.size();
+    }
+
+  private:
+    /* A range of `order` that is swept either in parallel or by a single thread. */
+    struct Segment {
+      size_t begin; // Position of the first node of the segment.
+      size_t end; // Position after the last node of the segment.
+      bool parallel; // Whether the nodes are independent of each other and can be swept in parallel.
+    };
+
+    const Tape<Scalar> *tape; // Tape that the schedule was created for.
+    Index nodes; // Number of nodes in the tape when the schedule was created.
+    size_t edges; // Number of edges in the tape when the schedule was created.
+    Index last; // Position of the first edge of the last node when the schedule was created.
+#ifndef NDEBUG
+    size_t generation; // Number of times the tape had been rewound when the schedule was created.
+#endif
+    size_t depth = 0; // Number of levels.
+    std::vector<Index> order; // Nodes with at least one edge, sorted by level.
+    std::vector<Segment> ranges; // Segments in order of increasing level.
+
+    /* Construct a schedule for the given tape, sweeping levels with at least the given number of nodes in parallel. */
+    Schedule(const Tape<Scalar> &tape_, size_t grain) : tape{&tape_}, nodes{tape_.size()}, edges{tape_.dependencies.size()}, last{(nodes > 0) ? tape_.offsets[nodes - 1] : 0} { // Constructor
+#ifndef NDEBUG
+      generation = tape_.generation;
+#endif
+      std::vector<Index> level(nodes, 0);
+      for (size_t i = 0; i < nodes; i++) {
+        size_t end = (i + 1 < nodes) ? tape_.offsets[i + 1] : tape_.dependencies.size();
+        for (size_t edge = tape_.offsets[i]; edge < end; edge++) {
+          level[i] = std::max(level[i], static_cast<Index>(level[tape_.dependencies[edge]] + 1));
+        }
+        depth = std::max(depth, static_cast<size_t>(level[i]) + 1);
+      }
+      // Sort the nodes by level with a counting sort, leaving out the leaves (level zero) since they have no edges.
+      // Afterwards, `starts[l]` is the position at which level `l + 1` starts (offset by the number of leaves).
+      std::vector<size_t> starts(depth + 1, 0);
+      for (size_t i = 0; i < nodes; i++) {
+        starts[level[i] + 1]++;
+      }
+      for (size_t l = 1; l <= depth; l++) {
+        starts[l] += starts[l - 1];
+      }
+      size_t leaves = starts[1];
+      order.resize(nodes - leaves);
+      for (size_t i = 0; i < nodes; i++) {
+        if (level[i] > 0) {
+          order[starts[level[i]]++ - leaves] = static_cast<Index>(i);
+        }
+      }
+      size_t begin = 0;
+      for (size_t l = 1; l < depth; l++) {
+        size_t end = starts[l] - leaves;
+        if (end - begin >= grain) {
+          ranges.push_back(Segment{begin, end, true});
+        } else if (!ranges.empty() && !ranges.back().parallel) {
+          ranges.back().end = end;
+        } else {
+          ranges.push_back(Segment{begin, end, false});
+        }
+        begin = end;
+      }
+    }
+
+    /* Determine if the schedule still describes the given tape, i.e. it is the tape that the schedule was created for
+    and it has the same numbers of nodes and edges and the same last node (and, in debug builds, has not been rewound)
+    since. A tape that was rewound and recorded again with the same shape cannot be told apart in release builds. */
+    bool describes(const Tape<Scalar> &tape_) const noexcept {
+      if (tape != &tape_ || nodes != tape_.size() || edges != tape_.dependencies.size()) {
+        return false;
+      }
+#ifndef NDEBUG
+      if (generation != tape_.generation) {
+        return false;
+      }
+#endif
+      return nodes == 0 || last == tape_.offsets[nodes - 1];
+    }
+  };
+}
+
+
+#endif // AUTOGRAD_SCHEDULE_HPP
@@ -0,0 +1,36 @@
+#ifndef AUTOGRAD_SCOPE_HPP
+#define AUTOGRAD_SCOPE_HPP
+
+
+#include "tape.hpp"
+#include "utils.hpp"
+
+namespace AutoGrad {
+
+  /* Pauses recording on a tape for as long as it is in scope (see `Tape::pause()`), e.g. while evaluating a function in
+  a line search whose gradient is never needed. Variables created or computed in the scope are constants. */
+  template<FloatingPoint Scalar>
+  class NoGradScope {
+  public:
+    /* Construct a new scope object that pauses recording on the given tape. */
+    explicit NoGradScope(Tape<Scalar> &tape_) noexcept : tape(tape_) { // Constructor
+      tape.pause();
+    }
+
+    // Disallow copy semantics
+    // Each scope resumes recording exactly once, when it is destroyed.
+    NoGradScope(const NoGradScope<Scalar> &scope) = delete; // Copy constructor
+    NoGradScope<Scalar> &operator=(const NoGradScope<Scalar> &scope) = delete; // Copy assignment operator
+
+    /* Destroy the scope object, resuming recording on the tape. */
+    ~NoGradScope() { // Destructor
+      tape.resume();
+    }
+
+  private:
+    Tape<Scalar> &tape; // Tape on which recording is paused.
+  };
+}
+
+
+#endif // AUTOGRAD_SCOPE_HPP
@@ -3,9 +3,19 @@
 #define AUTOGRAD_TAPE_HPP
 
 
-#include "node.hpp"
+#include "arena.hpp"
+#include "instrument.hpp"
+#include "jacobian.hpp"
+#include "kernel.hpp"
+#include "matrix.hpp"
+#include "opcode.hpp"
+#include "operations.hpp"
+#include "program.hpp"
+#include "saved.hpp"
+#include "schedule.hpp"
 #include "utils.hpp"
 #include "variable.hpp"
+#include "weight.hpp"
 
 namespace AutoGrad {
   template<FloatingPoint Scalar>
@@ -14,12 +24,41 @@ namespace AutoGrad {
   template<FloatingPoint Scalar>
   class Gradient; // Forward declaration
 
+  template<FloatingPoint S>
+  class LeafExpression; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class ParallelTape; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Schedule; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Matrix; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Program; // Forward declaration
+
+  template<FloatingPoint Scalar, size_t Capacity>
+  class Partials; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Rollout; // Forward declaration
+
   /* A gradient tape that stores a computational graph recording mathematical operations perfomed on variables in order
   to compute derivatives. */
   template<FloatingPoint Scalar>
   class Tape {
     friend class Variable<Scalar>;
+    friend class ParallelTape<Scalar>;
+    friend class Schedule<Scalar>;
     friend class Gradient<Scalar>;
+    friend class Matrix<Scalar>;
+    friend class Rollout<Scalar>;
+    friend class Site<Scalar>;
+
+    template<FloatingPoint S, size_t Capacity>
+    friend class Partials;
 
     // A bunch of arithmetic operations and elementary mathematical functions that have to be declared as friends so
     // that they can access private members and methods.
@@ -31,37 +70,37 @@ namespace AutoGrad {
     friend Variable<S> operator+(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> operator+(const Variable<S> &variable, S scalar);
+    friend Variable<S> operator+(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> operator+(S scalar, const Variable<S> &variable);
+    friend Variable<S> operator+(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     template<FloatingPoint S>
     friend Variable<S> operator-(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> operator-(const Variable<S> &variable, S scalar);
+    friend Variable<S> operator-(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> operator-(S scalar, const Variable<S> &variable);
+    friend Variable<S> operator-(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     template<FloatingPoint S>
     friend Variable<S> operator*(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> operator*(const Variable<S> &variable, S scalar);
+    friend Variable<S> operator*(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> operator*(S scalar, const Variable<S> &variable);
+    friend Variable<S> operator*(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     template<FloatingPoint S>
     friend Variable<S> operator/(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> operator/(const Variable<S> &variable, S scalar);
+    friend Variable<S> operator/(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> operator/(S scalar, const Variable<S> &variable);
+    friend Variable<S> operator/(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     // Exponential and logarithmic functions
 
@@ -69,10 +108,10 @@ namespace AutoGrad {
     friend Variable<S> pow(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> pow(const Variable<S> &variable, S scalar);
+    friend Variable<S> pow(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> pow(S scalar, const Variable<S> &variable);
+    friend Variable<S> pow(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     template<FloatingPoint S>
     friend Variable<S> sqrt(const Variable<S> &variable);
@@ -93,10 +132,10 @@ namespace AutoGrad {
     friend Variable<S> log(const Variable<S> &variable, const Variable<S> &base);
 
     template<FloatingPoint S>
-    friend Variable<S> log(const Variable<S> &variable, S base);
+    friend Variable<S> log(const Variable<S> &variable, std::type_identity_t<S> base);
 
     template<FloatingPoint S>
-    friend Variable<S> log(S scalar, const Variable<S> &base);
+    friend Variable<S> log(std::type_identity_t<S> scalar, const Variable<S> &base);
 
     template<FloatingPoint S>
     friend Variable<S> ln(const Variable<S> &variable);
@@ -186,10 +225,40 @@ namespace AutoGrad {
     template<FloatingPoint S>
     friend Variable<S> abs(const Variable<S> &variable);
 
+    // Fused expressions
+
+    template<FloatingPoint S>
+    friend LeafExpression<S> fuse(const Variable<S> &variable);
+
   public:
+    /* When the partial derivatives of an operation are computed. */
+    enum class Mode {
+      Eager, // While recording the operation (the default), so that sweeping the tape only multiplies and adds.
+      Lazy, // While sweeping the tape, from the op codes and the values of the nodes, for nodes that the output depends on.
+    };
+
+    /* Statistics about the computational graph recorded by a tape. */
+    struct Statistics {
+      size_t nodes; // Number of nodes.
+      size_t edges; // Number of edges (i.e. stored partial derivatives).
+      size_t bytes; // Memory used by the nodes and edges (excluding unused capacity).
+      size_t copies; // Number of copies of variables made (recorded as nodes unless `AUTOGRAD_ALIAS_COPIES` is defined).
+      size_t kernels; // Number of operations on matrices (each recorded as a single kernel instead of as edges).
+    };
+
     /* Construct a new tape object. */
     Tape() noexcept = default; // Default constructor
 
+    /* Construct a new tape object that computes partial derivatives in the given mode. A lazy tape records only the op
+    code and value of each node, so evaluating functions without computing a gradient (e.g. for validation or in a line
+    search) skips the derivative math entirely. The derivatives are computed when sweeping the tape instead, but only for
+    nodes that the output depends on (unless it depends on operations on matrices). */
+    explicit Tape(Mode mode_) noexcept : lazy{mode_ == Mode::Lazy} {} // Constructor
+
+    /* Construct a new tape object that allocates the memory for its nodes and edges from the given memory resource (see
+    `AutoGrad::Arena`) and computes partial derivatives in the given mode. */
+    explicit Tape(std::pmr::memory_resource *resource, Mode mode_ = Mode::Eager) noexcept : weights(resource), exact(resource), dependencies(resource), offsets(resource), codes(resource), constants(resource), vals(resource), lazy{mode_ == Mode::Lazy} {} // Constructor
+
     // Disallow copy semantics
     // Each tape has variables bound to that specific reference so copying tapes would lead to weird behavior.
     Tape(const Tape<Scalar> &tape) noexcept = delete; // Copy constructor
@@ -203,33 +272,900 @@ namespace AutoGrad {
     /* Assign a new tape by moving the given one. */
     Tape<Scalar> &operator=(Tape<Scalar> &&tape) noexcept = default; // Move assignment operator
 
-    /* Instantiate a new variable object (that is permanently bound to the tape) as part of the computational graph. */
+    /* Retrieve the mode in which the tape computes partial derivatives. */
+    Mode mode() const noexcept {
+      return lazy ? Mode::Lazy : Mode::Eager;
+    }
+
+    /* Instantiate a new variable object (that is permanently bound to the tape) as part of the computational graph, or
+    a constant one if recording is paused. */
     Variable<Scalar> variable(Scalar value) {
-      return Variable<Scalar>(*this, value, push_back());
+      return Variable<Scalar>(*this, value, leaf(value));
+    }
+
+    /* Instantiate a new constant variable object: it is never recorded, so operations between it and a variable
+    record a single edge (as with a scalar) and operations between constants record nothing. Its partial derivatives are
+    zero. Use `AutoGrad::Constant` instead when it is known at compile time that a value is a constant. */
+    Variable<Scalar> constant(Scalar value) noexcept {
+      return Variable<Scalar>(*this, value, passive);
+    }
+
+    /* Pause recording (until a matching call to `resume()`, see `AutoGrad::NoGradScope`). While paused, operations on
+    variables only compute values: nothing is recorded and their results (as well as new variables and copies) are
+    constants, whose partial derivatives are zero and which are treated as scalars by later operations. The same goes
+    for matrices and operations on them. Pauses can be nested. */
+    void pause() noexcept {
+      pauses++;
+    }
+
+    /* Resume recording after a call to `pause()`. */
+    void resume() {
+      if (pauses == 0) {
+        throw std::logic_error("`AutoGrad::Tape::resume()` called without a matching `AutoGrad::Tape::pause()`");
+      }
+      pauses--;
+    }
+
+    /* Determine if the tape is recording operations (i.e. not paused). */
+    bool recording() const noexcept {
+      return pauses == 0;
+    }
+
+    /* Instantiate a new matrix object (whose elements are variables permanently bound to the tape) with the given number
+    of rows and columns and values in row-major order, or a constant one if recording is paused. */
+    Matrix<Scalar> matrix(size_t rows, size_t columns, std::span<const Scalar> values) {
+      if (values.size() != rows * columns) {
+        throw std::invalid_argument("Number of values does not match the shape of the `AutoGrad::Matrix`");
+      }
+      Index index = (pauses == 0) ? size() : passive;
+      for (size_t element = 0; element < values.size() && pauses == 0; element++) {
+        push_back(values[element]);
+      }
+      return Matrix<Scalar>(*this, rows, columns, std::make_shared<const std::vector<Scalar>>(values.begin(), values.end()), index);
+    }
+
+    /* Instantiate a new matrix object with the given number of rows and columns whose elements are copies of the given
+    variables in row-major order (each recorded as a new node, so that the elements are consecutive on the tape). The
+    matrix is a constant if recording is paused or all the variables are constants; otherwise, the constants among them
+    are recorded as leaves. */
+    Matrix<Scalar> matrix(size_t rows, size_t columns, std::span<const Variable<Scalar>> variables) {
+      if (variables.size() != rows * columns) {
+        throw std::invalid_argument("Number of variables does not match the shape of the `AutoGrad::Matrix`");
+      }
+      auto values = std::make_shared<std::vector<Scalar>>();
+      values->reserve(variables.size());
+      for (const Variable<Scalar> &variable : variables) {
+        if (this != &variable.tape) {
+          throw std::invalid_argument("`AutoGrad::Variable` not from the same `AutoGrad::Tape`");
+        }
+        validate(variable);
+        values->push_back(variable.val);
+      }
+      if (std::none_of(variables.begin(), variables.end(), [&](const Variable<Scalar> &variable) { return tracked(variable); })) {
+        return Matrix<Scalar>(*this, rows, columns, std::move(values), passive);
+      }
+      Index index = size();
+      for (const Variable<Scalar> &variable : variables) {
+        if (tracked(variable)) {
+          push_back(Opcodes::copy, variable.val, 1.0, variable.index);
+        } else {
+          push_back(variable.val);
+        }
+      }
+      return Matrix<Scalar>(*this, rows, columns, std::move(values), index);
+    }
+
+    /* Compute the Jacobian of the given output variables with respect to the given input variables. Rather than
+    sweeping the tape once per output, the outputs are seeded in blocks of `Width` and a vector of `Width` adjoints is
+    propagated per node in a single sweep, so the tape is only read once per block. The fixed width lets the inner loop
+    over the adjoints be unrolled and vectorized; the adjoint buffer takes `Width` times the memory of a gradient. */
+    template<size_t Width = 8>
+    Jacobian<Scalar> jacobian(std::span<const Variable<Scalar>> outputs, std::span<const Variable<Scalar>> inputs) const {
+      static_assert(Width > 0, "`Width` must be positive");
+      Index stop = size();
+      for (const Variable<Scalar> &input : inputs) {
+        if (this != &input.tape) {
+          throw std::invalid_argument("`AutoGrad::Variable` not from the same `AutoGrad::Tape`");
+        }
+        validate(input);
+        stop = std::min(stop, input.index);
+      }
+      for (const Variable<Scalar> &output : outputs) {
+        if (this != &output.tape) {
+          throw std::invalid_argument("`AutoGrad::Variable` not from the same `AutoGrad::Tape`");
+        }
+        validate(output);
+      }
+      Jacobian<Scalar> jacobian_(outputs.size(), inputs.size());
+      std::vector<Scalar> adjoints;
+      for (size_t block = 0; block < outputs.size(); block += Width) {
+        size_t lanes = std::min(Width, outputs.size() - block);
+        // Constant outputs are not seeded, which leaves their rows zero.
+        Index start = 0;
+        for (size_t lane = 0; lane < lanes; lane++) {
+          if (outputs[block + lane].index != passive) {
+            start = std::max(start, outputs[block + lane].index);
+          }
+        }
+        adjoints.assign((static_cast<size_t>(start) + 1) * Width, 0.0);
+        for (size_t lane = 0; lane < lanes; lane++) {
+          if (outputs[block + lane].index != passive) {
+            adjoints[outputs[block + lane].index * Width + lane] = 1.0;
+          }
+        }
+        sweep<Width>(adjoints, start, std::min(stop, start));
+        for (size_t lane = 0; lane < lanes; lane++) {
+          for (size_t column = 0; column < inputs.size(); column++) {
+            Index input = inputs[column].index;
+            if (input <= start) {
+              jacobian_.values[(block + lane) * inputs.size() + column] = adjoints[input * Width + lane];
+            }
+          }
+        }
+      }
+      return jacobian_;
+    }
+
+    /* Create a schedule for sweeping the tape backwards on several threads (see `AutoGrad::Schedule`). Levels of the
+    computational graph with at least `grain` nodes are swept in parallel and narrower ones by a single thread. Only
+    tapes of floating-point scalars can be scheduled, since the threads add to the adjoints atomically. */
+    Schedule<Scalar> schedule(size_t grain = 4096) const requires std::floating_point<Scalar> {
+      if (!kernels.empty()) {
+        throw std::logic_error("`AutoGrad::Schedule` does not support tapes with operations on `AutoGrad::Matrix`s");
+      }
+      return Schedule<Scalar>(*this, std::max(grain, static_cast<size_t>(1)));
+    }
+
+    /* Compile the computational graph of the given output variable into a program that can be evaluated again with
+    new values of the given input variables, which must be leaves, and differentiated with respect to them (see
+    `AutoGrad::Program`). Only the nodes that the output depends on are kept. Fused expressions and operations on
+    matrices store their partial derivatives rather than how to recompute them, so they cannot be compiled. */
+    Program<Scalar> compile(const Variable<Scalar> &output, std::span<const Variable<Scalar>> inputs) const {
+      if (this != &output.tape) {
+        throw std::invalid_argument("`AutoGrad::Variable` not from the same `AutoGrad::Tape`");
+      }
+      validate(output);
+      if (output.index == passive) {
+        throw std::invalid_argument("Output of an `AutoGrad::Program` is a constant");
+      }
+      std::vector<Index> leaves;
+      leaves.reserve(inputs.size());
+      for (const Variable<Scalar> &input : inputs) {
+        if (this != &input.tape) {
+          throw std::invalid_argument("`AutoGrad::Variable` not from the same `AutoGrad::Tape`");
+        }
+        validate(input);
+        if (input.index == passive || codes[input.index] != Opcodes::leaf) {
+          throw std::invalid_argument("Input of an `AutoGrad::Program` is not a leaf of the `AutoGrad::Tape`");
+        }
+        leaves.push_back(input.index);
+      }
+      // Mark the nodes that the output depends on, sweeping the edges backwards as `sweep()` does.
+      size_t nodes = static_cast<size_t>(output.index) + 1;
+      std::vector<bool> live(nodes, false);
+      live[output.index] = true;
+      size_t end = (nodes < offsets.size()) ? offsets[nodes] : dependencies.size();
+      for (size_t i = nodes; i-- > 0;) {
+        size_t begin = offsets[i];
+        if (live[i]) {
+          if (codes[i] == Opcodes::opaque) {
+            throw std::logic_error("`AutoGrad::Program` does not support fused expressions or operations on `AutoGrad::Matrix`s");
+          }
+          for (size_t edge = begin; edge < end; edge++) {
+            live[dependencies[edge]] = true;
+          }
+        }
+        end = begin;
+      }
+      // Copy the live nodes in order, renumbering them and their dependencies.
+      Program<Scalar> program;
+      std::vector<Index> remap(nodes, 0);
+      std::vector<size_t> slots(nodes, Program<Scalar>::none);
+      for (size_t i = 0, constant = 0; i < nodes; i++) {
+        bool stores = Opcodes::constant(codes[i]);
+        if (live[i]) {
+          remap[i] = static_cast<Index>(program.codes.size());
+          program.codes.push_back(codes[i]);
+          program.offsets.push_back(static_cast<Index>(program.dependencies.size()));
+          size_t last = (i + 1 < offsets.size()) ? offsets[i + 1] : dependencies.size();
+          for (size_t edge = offsets[i]; edge < last; edge++) {
+            program.dependencies.push_back(remap[dependencies[edge]]);
+          }
+          if (stores) {
+            slots[i] = program.constants.size();
+            program.constants.push_back(constants[constant]);
+          }
+        }
+        constant += stores;
+      }
+      program.offsets.push_back(static_cast<Index>(program.dependencies.size()));
+      // Inputs that the output does not depend on keep no node and always have a partial derivative of zero.
+      for (Index leaf : leaves) {
+        bool used = leaf < nodes && live[leaf];
+        program.inputs.push_back(used ? remap[leaf] : Program<Scalar>::none);
+        program.slots.push_back(used ? slots[leaf] : Program<Scalar>::none);
+      }
+      program.values.assign(program.codes.size(), 0.0);
+      program.adjoints.assign(program.codes.size(), 0.0);
+      program.gradients.assign(inputs.size(), 0.0);
+      program.run();
+      return program;
+    }
+
+    /* Retrieve statistics about the computational graph recorded so far. */
+    Statistics statistics() const noexcept {
+      return Statistics{
+        .nodes = offsets.size(),
+        .edges = dependencies.size(),
+        .bytes = offsets.size() * (sizeof(Index) + sizeof(Opcode)) + weights.size() * sizeof(Weight<Scalar>) + dependencies.size() * sizeof(Index) + (exact.size() + constants.size() + vals.size()) * sizeof(Scalar),
+        .copies = copies,
+        .kernels = kernels.size(),
+      };
+    }
+
+#ifdef AUTOGRAD_INSTRUMENT
+    /* Retrieve the counters that the tape keeps about what it records and how long it spends sweeping (only if
+    `AUTOGRAD_INSTRUMENT` is defined). */
+    const Instrumentation &instrumentation() const noexcept {
+      profile.allocated = weights.capacity() * sizeof(Weight<Scalar>) + dependencies.capacity() * sizeof(Index) + offsets.capacity() * sizeof(Index) + codes.capacity() * sizeof(Opcode) + (exact.capacity() + constants.capacity() + vals.capacity()) * sizeof(Scalar);
+      profile.blocks = (weights.capacity() + exact.capacity() + dependencies.capacity() + offsets.capacity() + codes.capacity() + constants.capacity() + vals.capacity()) / AUTOGRAD_BLOCK_SIZE;
+      return profile;
+    }
+#endif
+
+    /* Retrieve a mark at the current end of the tape that it can later be rewound to. */
+    Index mark() const noexcept {
+      return size();
+    }
+
+    /* Discard every node recorded after the given mark, keeping the allocated memory so that the tape can be reused
+    (e.g. across iterations of an optimizer) without having to regrow. Variables created before the mark stay valid but
+    those created after it must no longer be used, which is checked when `NDEBUG` is not defined. */
+    void rewind(Index mark) {
+      if (mark > size()) {
+        throw std::invalid_argument("Mark is past the end of the `AutoGrad::Tape`");
+      }
+      size_t edges = (mark < size()) ? offsets[mark] : dependencies.size();
+      size_t stored = constants.size();
+      for (size_t i = mark; i < size(); i++) {
+        stored -= Opcodes::constant(codes[i]);
+      }
+      offsets.truncate(mark);
+      codes.truncate(mark);
+      constants.truncate(stored);
+      vals.truncate(lazy ? mark : 0);
+      weights.truncate(lazy ? 0 : edges);
+      exact.truncate(lazy ? edges : 0);
+      dependencies.truncate(edges);
+      while (!kernels.empty() && kernels.back().end > mark) {
+        kernels.pop_back();
+      }
+#ifndef NDEBUG
+      generations.resize(mark);
+      generation++;
+#endif
+    }
+
+    /* Discard every node that none of the given variables depend on and renumber the remaining ones in place (keeping
+    their order), so that sweeping the tape afterwards skips neither memory nor time on branches that were never used.
+    The given variables are updated to refer to the renumbered nodes. The result maps the index of each node before
+    compacting to its index after compacting (or to that of constants if it was discarded), and `remap()` uses it to
+    update any other variable. Every other variable and mark must no longer be used, which is checked for variables
+    when `NDEBUG` is not defined. Kernels do not expose the nodes they depend on, so tapes with operations on matrices
+    cannot be compacted. */
+    std::vector<Index> compact(std::span<Variable<Scalar>> variables) {
+      if (!kernels.empty()) {
+        throw std::logic_error("`AutoGrad::Tape::compact()` does not support tapes with operations on `AutoGrad::Matrix`s");
+      }
+      std::vector<bool> live(size(), false);
+      for (const Variable<Scalar> &variable : variables) {
+        if (this != &variable.tape) {
+          throw std::invalid_argument("`AutoGrad::Variable` not from the same `AutoGrad::Tape`");
+        }
+        validate(variable);
+        if (variable.index != passive) {
+          live[variable.index] = true;
+        }
+      }
+      size_t end = dependencies.size();
+      for (size_t i = size(); i-- > 0;) {
+        size_t begin = offsets[i];
+        if (live[i]) {
+          for (size_t edge = begin; edge < end; edge++) {
+            live[dependencies[edge]] = true;
+          }
+        }
+        end = begin;
+      }
+      // Move each live node to its new position, which never exceeds its old one (and the same goes for its edges and
+      // constant), so nothing is overwritten before it is read.
+      std::vector<Index> table(size(), passive);
+      size_t nodes = 0;
+      size_t edges = 0;
+      size_t stored = 0;
+      for (size_t i = 0, constant = 0; i < table.size(); i++) {
+        size_t begin = offsets[i];
+        end = (i + 1 < table.size()) ? offsets[i + 1] : dependencies.size();
+        bool stores = Opcodes::constant(codes[i]);
+        if (live[i]) {
+          table[i] = static_cast<Index>(nodes);
+          offsets[nodes] = static_cast<Index>(edges);
+          codes[nodes] = codes[i];
+          if (lazy) {
+            vals[nodes] = vals[i];
+          }
+          for (size_t edge = begin; edge < end; edge++, edges++) {
+            if (lazy) {
+              exact[edges] = exact[edge];
+            } else {
+              weights[edges] = weights[edge];
+            }
+            dependencies[edges] = table[dependencies[edge]];
+          }
+          if (stores) {
+            constants[stored++] = constants[constant];
+          }
+          nodes++;
+        }
+        constant += stores;
+      }
+      offsets.truncate(nodes);
+      codes.truncate(nodes);
+      vals.truncate(lazy ? nodes : 0);
+      weights.truncate(lazy ? 0 : edges);
+      exact.truncate(lazy ? edges : 0);
+      dependencies.truncate(edges);
+      constants.truncate(stored);
+#ifndef NDEBUG
+      generation++;
+      generations.assign(nodes, generation);
+#endif
+      for (Variable<Scalar> &variable : variables) {
+        remap(variable, table);
+      }
+      return table;
+    }
+
+    /* Update a variable after `compact()` given the table that it returned. A variable whose node was discarded becomes
+    a constant. */
+    void remap(Variable<Scalar> &variable, std::span<const Index> table) const {
+      if (this != &variable.tape) {
+        throw std::invalid_argument("`AutoGrad::Variable` not from the same `AutoGrad::Tape`");
+      }
+      if (variable.index != passive) {
+        if (variable.index >= table.size()) {
+          throw std::out_of_range("`AutoGrad::Variable` not covered by the table of `AutoGrad::Tape::compact()`");
+        }
+        variable.index = table[variable.index];
+      }
+#ifndef NDEBUG
+      variable.generation = generation;
+#endif
+    }
+
+    /* Save the computational graph to the file with the given path together with the given output and input variables,
+    so that it can be loaded back with `AutoGrad::SavedTape` (possibly in another process or on another machine) and
+    the gradients of the outputs with respect to the inputs computed without recording again. In lazy mode the partial
+    derivatives are computed as they are written. Operations on matrices store kernels rather than edges, so they
+    cannot be saved. */
+    void save(const std::string &path, std::span<const Variable<Scalar>> outputs, std::span<const Variable<Scalar>> inputs) const requires std::floating_point<Scalar> {
+      if (!kernels.empty()) {
+        throw std::logic_error("`AutoGrad::Tape::save()` does not support tapes with operations on `AutoGrad::Matrix`s");
+      }
+      for (std::span<const Variable<Scalar>> variables : {outputs, inputs}) {
+        for (const Variable<Scalar> &variable : variables) {
+          if (this != &variable.tape) {
+            throw std::invalid_argument("`AutoGrad::Variable` not from the same `AutoGrad::Tape`");
+          }
+          validate(variable);
+        }
+      }
+      using Saved = SavedTape<Scalar>;
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      if (!file) {
+        throw std::system_error(errno, std::generic_category(), "Cannot create the file of an `AutoGrad::SavedTape`");
+      }
+      typename Saved::Header header = {
+        .magic = Saved::magic,
+        .version = Saved::version,
+        .order = Saved::order,
+        .scalar = sizeof(Scalar),
+        .index = sizeof(Index),
+        .nodes = offsets.size(),
+        .edges = dependencies.size(),
+        .constants = constants.size(),
+        .outputs = outputs.size(),
+        .inputs = inputs.size(),
+      };
+      size_t position = 0;
+      // Write the elements given by calling the given function on each index in `[0, count)` as the next section.
+      auto section = [&]<typename T>(size_t count, auto element) {
+        static constexpr char padding[Saved::alignment] = {};
+        size_t begin = Saved::align(position);
+        file.write(padding, static_cast<std::streamsize>(begin - position));
+        std::array<T, 1024> buffer;
+        for (size_t first = 0; first < count; first += buffer.size()) {
+          size_t last = std::min(count, first + buffer.size());
+          for (size_t k = first; k < last; k++) {
+            buffer[k - first] = element(k);
+          }
+          file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>((last - first) * sizeof(T)));
+        }
+        position = begin + count * sizeof(T);
+      };
+      file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      position = sizeof(header);
+      section.template operator()<Index>(offsets.size(), [&](size_t i) { return offsets[i]; });
+      section.template operator()<Index>(dependencies.size(), [&](size_t edge) { return dependencies[edge]; });
+      size_t node = 0;
+      section.template operator()<Scalar>(dependencies.size(), [&](size_t edge) {
+        if (!lazy) {
+          return static_cast<Scalar>(weights[edge]);
+        }
+        // Edges are written in order, so the node that owns each one only moves forwards.
+        while (node + 1 < offsets.size() && offsets[node + 1] <= edge) {
+          node++;
+        }
+        return partial(node, edge);
+      });
+      section.template operator()<Opcode>(codes.size(), [&](size_t i) { return codes[i]; });
+      section.template operator()<Scalar>(constants.size(), [&](size_t constant) { return constants[constant]; });
+      section.template operator()<Index>(outputs.size(), [&](size_t output) { return outputs[output].index; });
+      section.template operator()<Scalar>(outputs.size(), [&](size_t output) { return outputs[output].val; });
+      section.template operator()<Index>(inputs.size(), [&](size_t input) { return inputs[input].index; });
+      section.template operator()<Scalar>(inputs.size(), [&](size_t input) { return inputs[input].val; });
+      file.flush();
+      if (!file) {
+        throw std::system_error(errno, std::generic_category(), "Cannot write the file of an `AutoGrad::SavedTape`");
+      }
+    }
+
+    /* Discard every node (and so invalidate every variable bound to the tape), keeping the allocated memory. */
+    void clear() {
+      rewind(0);
     }
 
   private:
-    std::vector<Node<Scalar>> nodes; // Internal representation of the computational graph.
+    // The computational graph is stored as a structure of arrays in compressed sparse row form: the edges of node `i`
+    // occupy the range `[offsets[i], offsets[i + 1])` of `weights` and `dependencies` (or `[offsets[i], edges)` for the
+    // last node). Leaves have no edges and unary operations have a single one, so neither pays for unused entries. The
+    // arrays grow in fixed-size blocks, so recording a node never moves the nodes recorded before it.
+    Arena<Weight<Scalar>> weights; // Derivative of each node's output with respect to the input along each edge.
+    Arena<Scalar> exact; // Replaces `weights` in lazy mode, always in full precision since some of them are operands.
+    Arena<Index> dependencies; // Index of the parent node along each edge.
+    Arena<Index> offsets; // Position of each node's first edge.
+    Arena<Opcode> codes; // Op code of each node (see `AutoGrad::Opcodes`), so that it can be compiled.
+    Arena<Scalar> constants; // Value of each leaf and constant operand, in the order of their nodes.
+    Arena<Scalar> vals; // Value of each node (lazy mode only).
+    bool lazy = false; // Whether partial derivatives are computed while sweeping (see `Mode::Lazy`).
+    size_t pauses = 0; // Number of calls to `pause()` without a matching call to `resume()`.
+
+    // Index of constant variables, which have no node (it is never reached since it exceeds the capacity of the tape).
+    static constexpr Index passive = std::numeric_limits<Index>::max();
+    size_t copies = 0; // Number of copies of variables made.
+
+    /* A kernel (see `AutoGrad::Kernel`) together with the range of nodes that hold its result. */
+    struct KernelRange {
+      Index begin; // Index of the first node of the result.
+      Index end; // Index after the last node of the result.
+      std::unique_ptr<Kernel<Scalar>> kernel; // Kernel that propagates the adjoints of the result.
+    };
+
+    std::vector<KernelRange> kernels; // Kernels in the order in which they were recorded.
+#ifdef AUTOGRAD_INSTRUMENT
+    mutable Instrumentation profile; // Counters about what the tape records and how long it spends sweeping.
+#endif
+#ifndef NDEBUG
+    size_t generation = 0; // Number of times the tape has been rewound.
+    std::vector<size_t> generations; // Generation in which each node was recorded.
+#endif
+
+    /* Number of nodes in the computational graph. */
+    Index size() const noexcept {
+      return static_cast<Index>(offsets.size());
+    }
 
-    /* Add an empty node to the computational graph that represents a new variable. */
-    size_t push_back() {
-      size_t size = nodes.size();
-      nodes.push_back(Node<Scalar>(std::make_pair(0.0, 0.0), std::make_pair(size, size)));
-      return size;
+    /* Ensure that a new node with the given number of edges can still be addressed by `AutoGrad::Index`. */
+    void checkCapacity(size_t edges) const {
+      if (offsets.size() >= std::numeric_limits<Index>::max() || dependencies.size() + edges > std::numeric_limits<Index>::max()) {
+        throw std::length_error("`AutoGrad::Tape` exceeds the range of `AutoGrad::Index` (define `AUTOGRAD_WIDE_INDICES`)");
+      }
+    }
+
+    /* Append a node with the given op code, value and number of edges (which are to be filled in by the caller) and
+    return its index. */
+    Index open(Opcode code, Scalar value, size_t edges) {
+      checkCapacity(edges);
+      Index index = size();
+      offsets.push_back(static_cast<Index>(dependencies.size()));
+      codes.push_back(code);
+      if (lazy) {
+        vals.push_back(value);
+      }
+#ifdef AUTOGRAD_INSTRUMENT
+      profile.record(code, statistics().bytes);
+#endif
+#ifndef NDEBUG
+      generations.push_back(generation);
+#endif
+      return index;
+    }
+
+    /* Append an edge from the most recently opened node to the given dependency. */
+    void edge(Scalar weight, Index dependency) {
+#ifndef NDEBUG
+      if (dependency >= size()) {
+        throw std::invalid_argument("`AutoGrad::Variable` refers to a node that was discarded by `AutoGrad::Tape::rewind()`");
+      }
+#endif
+      if (lazy) {
+        exact.push_back(weight);
+      } else {
+        weights.push_back(static_cast<Weight<Scalar>>(weight));
+      }
+      dependencies.push_back(dependency);
+    }
+
+    /* Determine if a variable is recorded on the tape, i.e. it is not a constant and recording is not paused. */
+    bool tracked(const Variable<Scalar> &variable) const noexcept {
+      return pauses == 0 && variable.index != passive;
+    }
+
+    /* Add a node that represents a new variable with the given value if recording is not paused, and return its index
+    (or that of constants otherwise). */
+    Index leaf(Scalar value) {
+      return (pauses == 0) ? push_back(value) : passive;
+    }
+
+    /* Add an empty node to the computational graph that represents a new variable with the given value. */
+    Index push_back(Scalar value) {
+      Index index = open(Opcodes::leaf, value, 0);
+      constants.push_back(value);
+      return index;
     }
 
     /* Add a node to the computational graph that stores the result of a unary operation. */
-    size_t push_back(Scalar weight, size_t dependency) {
-      size_t size = nodes.size();
-      nodes.push_back(Node<Scalar>(std::make_pair(weight, 0.0), std::make_pair(dependency, size)));
-      return size;
+    Index push_back(Opcode code, Scalar value, Scalar weight, Index dependency) {
+      Index index = open(code, value, 1);
+      edge(weight, dependency);
+      return index;
+    }
+
+    /* Add a node to the computational graph that stores the result of a binary operation with a constant operand. */
+    Index push_back(Opcode code, Scalar value, Scalar weight, Index dependency, Scalar constant) {
+      Index index = push_back(code, value, weight, dependency);
+      constants.push_back(constant);
+      return index;
     }
 
     /* Add a node to the computational graph that stores the result of a binary operation. */
-    size_t push_back(Scalar weight1, size_t dependency1, Scalar weight2, size_t dependency2) {
-      size_t size = nodes.size();
-      nodes.push_back(Node<Scalar>(std::make_pair(weight1, weight2), std::make_pair(dependency1, dependency2)));
-      return size;
+    Index push_back(Opcode code, Scalar value, Scalar weight1, Index dependency1, Scalar weight2, Index dependency2) {
+      Index index = open(code, value, 2);
+      edge(weight1, dependency1);
+      edge(weight2, dependency2);
+      return index;
+    }
+
+    /* Add a node to the computational graph that stores the result of an operation with any number of operands, unless
+    recording is paused or it has no operands (i.e. it is a constant). */
+    Index push_back(Scalar value, std::span<const Scalar> weights_, std::span<const Index> dependencies_) {
+      if (pauses > 0 || dependencies_.empty()) {
+        return passive;
+      }
+      Index index = open(Opcodes::opaque, value, dependencies_.size());
+      for (size_t edge = 0; edge < dependencies_.size(); edge++) {
+        this->edge(weights_[edge], dependencies_[edge]);
+      }
+      return index;
+    }
+
+    /* Add nodes without edges to the computational graph that store the result of a kernel (one per given value), and
+    return the index of the first one. */
+    Index push_back(std::span<const Scalar> values_, std::unique_ptr<Kernel<Scalar>> kernel) {
+      Index index = size();
+      for (Scalar value : values_) {
+        open(Opcodes::opaque, value, 0);
+      }
+      kernels.push_back(KernelRange{index, size(), std::move(kernel)});
+      return index;
+    }
+
+    /* Make a copy of a variable and return its index: that of a new node depending on the original or, if
+    `AUTOGRAD_ALIAS_COPIES` is defined, that of the original itself (a copy has the same partial derivatives as the
+    original, so nothing needs to be recorded unless the copy should be treated as a separate input variable). */
+    Index copy(const Variable<Scalar> &variable) {
+      validate(variable);
+      if (!tracked(variable)) {
+        return passive;
+      }
+      copies++;
+#ifdef AUTOGRAD_ALIAS_COPIES
+      return variable.index;
+#else
+      return push_back(Opcodes::copy, variable.val, 1.0, variable.index);
+#endif
+    }
+
+    /* Record the result of applying a unary operation (see `AutoGrad::Operations`) to a variable. */
+    template<typename Operation>
+    Variable<Scalar> apply(const Variable<Scalar> &variable) {
+      validate(variable);
+      if (!tracked(variable)) {
+        return Variable<Scalar>(*this, Operation::value(variable.val), passive);
+      } else if (lazy) {
+        Scalar value = Operation::value(variable.val);
+        return Variable<Scalar>(*this, value, push_back(Opcodes::unary<Operation>, value, 0.0, variable.index));
+      }
+      auto [value, weight] = Operations::evaluate<Operation>(variable.val);
+      return Variable<Scalar>(*this, value, push_back(Opcodes::unary<Operation>, value, weight, variable.index));
+    }
+
+    /* Record the result of applying a binary operation (see `AutoGrad::Operations`) to two variables. */
+    template<typename Operation>
+    Variable<Scalar> apply(const Variable<Scalar> &variable1, const Variable<Scalar> &variable2) {
+      if (&variable1.tape != &variable2.tape) {
+        throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
+      }
+      validate(variable1);
+      validate(variable2);
+      // A constant operand is recorded as a scalar.
+      if (!tracked(variable2)) {
+        return apply<Operation>(variable1, variable2.val);
+      } else if (!tracked(variable1)) {
+        return apply<Operation>(variable1.val, variable2);
+      }
+      Scalar value = Operation::value(variable1.val, variable2.val);
+      if (lazy) {
+        return Variable<Scalar>(*this, value, push_back(Opcodes::binary<Operation>, value, 0.0, variable1.index, 0.0, variable2.index));
+      }
+      return Variable<Scalar>(*this, value, push_back(Opcodes::binary<Operation>, value, Operation::left(variable1.val, variable2.val, value), variable1.index, Operation::right(variable1.val, variable2.val, value), variable2.index));
+    }
+
+    /* Record the result of applying a binary operation (see `AutoGrad::Operations`) to a variable and a scalar. */
+    template<typename Operation>
+    Variable<Scalar> apply(const Variable<Scalar> &variable, Scalar scalar) {
+      validate(variable);
+      Scalar value = Operation::value(variable.val, scalar);
+      if (!tracked(variable)) {
+        return Variable<Scalar>(*this, value, passive);
+      }
+      Scalar weight = lazy ? scalar : Operation::left(variable.val, scalar, value);
+      return Variable<Scalar>(*this, value, push_back(Opcodes::variableScalar<Operation>, value, weight, variable.index, scalar));
+    }
+
+    /* Record the result of applying a binary operation (see `AutoGrad::Operations`) to a scalar and a variable. */
+    template<typename Operation>
+    Variable<Scalar> apply(Scalar scalar, const Variable<Scalar> &variable) {
+      validate(variable);
+      Scalar value = Operation::value(scalar, variable.val);
+      if (!tracked(variable)) {
+        return Variable<Scalar>(*this, value, passive);
+      }
+      Scalar weight = lazy ? scalar : Operation::right(scalar, variable.val, value);
+      return Variable<Scalar>(*this, value, push_back(Opcodes::scalarVariable<Operation>, value, weight, variable.index, scalar));
+    }
+
+    /* Check that a variable does not refer to a node that has been discarded by `rewind()` (and possibly re-recorded
+    since). This is only done when `NDEBUG` is not defined. */
+    void validate([[maybe_unused]] const Variable<Scalar> &variable) const {
+#ifndef NDEBUG
+      if (variable.index != passive && (variable.index >= size() || generations[variable.index] != variable.generation)) {
+        throw std::invalid_argument("`AutoGrad::Variable` refers to a node that was discarded by `AutoGrad::Tape::rewind()`");
+      }
+#endif
+    }
+
+    /* Check that a matrix does not refer to nodes that have been discarded by `rewind()`, in the same way as for a
+    variable. */
+    void validate([[maybe_unused]] const Matrix<Scalar> &matrix) const {
+#ifndef NDEBUG
+      if (matrix.index != passive && (matrix.index + matrix.height * matrix.width > size() || generations[matrix.index] != matrix.generation)) {
+        throw std::invalid_argument("`AutoGrad::Matrix` refers to nodes that were discarded by `AutoGrad::Tape::rewind()`");
+      }
+#endif
+    }
+
+    /* Retrieve the number of kernels whose result starts at or before the node with the given index. */
+    size_t kernelsUpTo(Index index) const {
+      return static_cast<size_t>(std::upper_bound(kernels.begin(), kernels.end(), index, [](Index index_, const KernelRange &range) {
+        return index_ < range.begin;
+      }) - kernels.begin());
+    }
+
+    /* Ask the memory resource to start reading in the block of nodes before the given index (and their edges), which a
+    reverse sweep is about to reach (see `AutoGrad::PrefetchingResource`). */
+    void prefetch(size_t end) const noexcept {
+      size_t begin = end - std::min(end, static_cast<size_t>(AUTOGRAD_BLOCK_SIZE));
+      if (begin == end) {
+        return;
+      }
+      size_t last = (end < offsets.size()) ? offsets[end] : dependencies.size();
+      offsets.prefetch(begin, end);
+      codes.prefetch(begin, end);
+      vals.prefetch(begin, end);
+      weights.prefetch(offsets[begin], last);
+      exact.prefetch(offsets[begin], last);
+      dependencies.prefetch(offsets[begin], last);
+    }
+
+    /* Propagate the adjoints (which must already be seeded) backwards through the computational graph, from the node
+    with the given start index down to (but excluding) the one with the given stop index. Later nodes cannot contribute
+    to the start node and the adjoints of the stop node and its predecessors are not needed, so both are skipped. Each
+    node's edges are contiguous in `weights` and `dependencies`, so the sweep streams through both arrays in reverse and
+    only the adjoint updates are scattered. The kernel of an operation on matrices is run once the sweep reaches the
+    first node of its result, at which point the adjoints of the whole result are complete. */
+    void sweep(std::vector<Scalar> &adjoints, Index start, Index stop = 0) const {
+#ifdef AUTOGRAD_INSTRUMENT
+      Instrumentation::Timer timer(profile);
+#endif
+      if (lazy) {
+        sweepLazy(adjoints, start, stop);
+        return;
+      }
+      size_t end = (static_cast<size_t>(start) + 1 < offsets.size()) ? offsets[start + 1] : dependencies.size();
+      size_t kernel = kernelsUpTo(start);
+      prefetch(static_cast<size_t>(start) + 1);
+      for (size_t i = start; i > stop; i--) {
+        if (i % AUTOGRAD_BLOCK_SIZE == 0) {
+          prefetch(i);
+        }
+        if (kernel > 0 && kernels[kernel - 1].begin == i) {
+          kernels[--kernel].kernel->backward(adjoints, 1, static_cast<Index>(i));
+        }
+        size_t begin = offsets[i];
+        Scalar adjoint = adjoints[i];
+        for (size_t edge = begin; edge < end; edge++) {
+          adjoints[dependencies[edge]] += weights[edge] * adjoint;
+        }
+        end = begin;
+      }
+    }
+
+    /* Propagate the adjoints backwards through the computational graph of a lazy tape in the same way as `sweep()`,
+    computing the partial derivatives of each node from its op code. Each node that the sweep reaches marks its
+    dependencies, so nodes that the start node does not depend on are skipped without computing their derivatives. A
+    kernel does not mark the nodes that it propagates adjoints to, so nothing is skipped if any were recorded before the
+    start node. */
+    void sweepLazy(std::vector<Scalar> &adjoints, Index start, Index stop) const {
+      size_t end = (static_cast<size_t>(start) + 1 < offsets.size()) ? offsets[start + 1] : dependencies.size();
+      size_t kernel = kernelsUpTo(start);
+      bool prune = (kernel == 0);
+      std::vector<bool> reached(prune ? static_cast<size_t>(start) + 1 : 0, false);
+      if (prune) {
+        reached[start] = true;
+      }
+      prefetch(static_cast<size_t>(start) + 1);
+      for (size_t i = start; i > stop; i--) {
+        if (i % AUTOGRAD_BLOCK_SIZE == 0) {
+          prefetch(i);
+        }
+        if (kernel > 0 && kernels[kernel - 1].begin == i) {
+          kernels[--kernel].kernel->backward(adjoints, 1, static_cast<Index>(i));
+        }
+        size_t begin = offsets[i];
+        if (!prune || reached[i]) {
+          Scalar adjoint = adjoints[i];
+          for (size_t edge = begin; edge < end; edge++) {
+            Index dependency = dependencies[edge];
+            adjoints[dependency] += partial(i, edge) * adjoint;
+            if (prune) {
+              reached[dependency] = true;
+            }
+          }
+        }
+        end = begin;
+      }
+    }
+
+    /* Compute the partial derivative of a node of a lazy tape along the given edge from its op code and the values of
+    its operands. The edges of copies and fused expressions store their weights as usual, and those of nodes with a
+    constant operand store the constant instead (in `exact`, so neither is rounded to `AutoGrad::Weight`). */
+    Scalar partial(size_t i, size_t edge) const {
+      Opcode code = codes[i];
+      Index dependency = dependencies[edge];
+      switch (Opcodes::kind(code)) {
+        case Opcodes::Kind::Unary:
+          return Opcodes::derivative(code, vals[dependency], vals[i]);
+        case Opcodes::Kind::Binary: {
+          size_t first = offsets[i];
+          Scalar x = vals[dependencies[first]];
+          Scalar y = vals[dependencies[first + 1]];
+          return (edge == first) ? Opcodes::left(code, x, y, vals[i]) : Opcodes::right(code, x, y, vals[i]);
+        }
+        case Opcodes::Kind::Left:
+          return Opcodes::left(code, vals[dependency], exact[edge], vals[i]);
+        case Opcodes::Kind::Right:
+          return Opcodes::right(code, exact[edge], vals[dependency], vals[i]);
+        default:
+          return exact[edge];
+      }
+    }
+
+    /* Propagate the adjoints (which must already be seeded) backwards through the computational graph from the node with
+    the given start index on the given number of threads, in the order given by the schedule. Within a parallel segment
+    the threads claim chunks of nodes from a shared counter and accumulate into the adjoints of the dependencies with
+    atomic additions, since nodes in the same level may share dependencies; the threads wait for each other at a barrier
+    after every segment. */
+    void sweep(std::vector<Scalar> &adjoints, Index start, const Schedule<Scalar> &schedule, size_t threads) const requires std::floating_point<Scalar> {
+#ifdef AUTOGRAD_INSTRUMENT
+      Instrumentation::Timer timer(profile);
+#endif
+      constexpr size_t chunk = 256;
+      const std::vector<Index> &order = schedule.order;
+      auto propagate = [&](Index i, auto add) {
+        if (i > start) {
+          return;
+        }
+        size_t end = (static_cast<size_t>(i) + 1 < offsets.size()) ? offsets[i + 1] : dependencies.size();
+        Scalar adjoint = adjoints[i];
+        for (size_t edge = offsets[i]; edge < end; edge++) {
+          add(adjoints[dependencies[edge]], (lazy ? partial(i, edge) : weights[edge]) * adjoint);
+        }
+      };
+      auto add = [](Scalar &target, Scalar value) {
+        target += value;
+      };
+      auto atomicAdd = [](Scalar &target, Scalar value) {
+        std::atomic_ref<Scalar>(target).fetch_add(value, std::memory_order_relaxed);
+      };
+      threads = std::max(threads, static_cast<size_t>(1));
+      std::vector<std::atomic<size_t>> cursors(schedule.ranges.size());
+      std::barrier barrier(static_cast<std::ptrdiff_t>(threads));
+      auto run = [&](size_t thread) {
+        for (size_t segment = schedule.ranges.size(); segment-- > 0;) {
+          auto [begin, end, parallel] = schedule.ranges[segment];
+          if (parallel && threads > 1) {
+            for (size_t position; (position = begin + cursors[segment].fetch_add(chunk, std::memory_order_relaxed)) < end;) {
+              for (size_t node = position; node < std::min(position + chunk, end); node++) {
+                propagate(order[node], atomicAdd);
+              }
+            }
+          } else if (thread == 0) {
+            for (size_t node = end; node-- > begin;) {
+              propagate(order[node], add);
+            }
+          }
+          if (threads > 1) {
+            barrier.arrive_and_wait();
+          }
+        }
+      };
+      std::vector<std::jthread> pool;
+      for (size_t thread = 1; thread < threads; thread++) {
+        pool.emplace_back(run, thread);
+      }
+      run(0);
+    }
+
+    /* Propagate vectors of `Width` adjoints (stored contiguously per node) backwards through the computational graph, in
+    the same way as `sweep()`. */
+    template<size_t Width>
+    void sweep(std::vector<Scalar> &adjoints, Index start, Index stop) const {
+#ifdef AUTOGRAD_INSTRUMENT
+      Instrumentation::Timer timer(profile);
+#endif
+      size_t end = (static_cast<size_t>(start) + 1 < offsets.size()) ? offsets[start + 1] : dependencies.size();
+      size_t kernel = kernelsUpTo(start);
+      prefetch(static_cast<size_t>(start) + 1);
+      for (size_t i = start; i > stop; i--) {
+        if (i % AUTOGRAD_BLOCK_SIZE == 0) {
+          prefetch(i);
+        }
+        if (kernel > 0 && kernels[kernel - 1].begin == i) {
+          kernels[--kernel].kernel->backward(adjoints, Width, static_cast<Index>(i));
+        }
+        size_t begin = offsets[i];
+        std::array<Scalar, Width> adjoint;
+        std::copy_n(adjoints.begin() + static_cast<std::ptrdiff_t>(i * Width), Width, adjoint.begin());
+        for (size_t edge = begin; edge < end; edge++) {
+          Scalar weight = lazy ? partial(i, edge) : weights[edge];
+          Scalar *target = adjoints.data() + dependencies[edge] * Width;
+          for (size_t lane = 0; lane < Width; lane++) {
+            target[lane] += weight * adjoint[lane];
+          }
+        }
+        end = begin;
+      }
     }
   };
 }
@@ -3,20 +3,69 @@
 #define AUTOGRAD_UTILS_HPP
 
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <chrono>
+#include <cerrno>
 #include <cmath>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <numbers>
+#include <numeric>
+#include <ostream>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 /* Contains all templated classes and functions from the AutoGrad library. */
 namespace AutoGrad {
 
+  /* Determines if a type is a dual number (see `AutoGrad::Dual`). */
+  template<typename T>
+  struct IsDual : std::false_type {};
+
   /* Determines if a type is a floating-point type (i.e., `float`, `double`, `long double`, or the fixed-width types
-  found in the standard header `<stdfloat>` for C++23). */
+  found in the standard header `<stdfloat>` for C++23) or a dual number over one. Recording operations on dual numbers
+  on a tape differentiates the reverse sweep itself in forward mode, which yields second-order derivatives (see
+  `AutoGrad::hessian()`). */
   template<typename T>
-  concept FloatingPoint = std::floating_point<T>;
+  concept FloatingPoint = std::floating_point<T> || IsDual<T>::value;
+
+  /* Determines if a type is a fused expression (see `AutoGrad::fuse()`), i.e. a tree of operations on variables that is
+  recorded on a tape as a single node. */
+  template<typename T>
+  concept Expression = requires(const T &expression) {
+    typename T::Scalar;
+    { T::leaves } -> std::convertible_to<size_t>;
+    { expression.value() } -> std::same_as<typename T::Scalar>;
+  };
+
+  /* Unsigned integer type used to address nodes and edges in a tape. It is 32 bits wide by default, which keeps the
+  tape compact and the reverse pass less bandwidth-bound; define `AUTOGRAD_WIDE_INDICES` to use `size_t` instead for
+  tapes that exceed 2^32 - 1 nodes or edges. */
+#ifdef AUTOGRAD_WIDE_INDICES
+  using Index = size_t;
+#else
+  using Index = std::uint32_t;
+#endif
 }
 
 
@@ -4,7 +4,7 @@
 
 
 #include "gradient.hpp"
-#include "node.hpp"
+#include "opcode.hpp"
 #include "tape.hpp"
 #include "utils.hpp"
 
@@ -15,12 +15,36 @@ namespace AutoGrad {
   template<FloatingPoint Scalar>
   class Gradient; // Forward declaration
 
+  template<FloatingPoint Scalar, size_t Capacity>
+  class Partials; // Forward declaration
+
+  template<FloatingPoint S>
+  class LeafExpression; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class ParallelTape; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Schedule; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Matrix; // Forward declaration
+
+  template<FloatingPoint Scalar>
+  class Rollout; // Forward declaration
+
   /* A floating-point variable type that uses information about operations performed on it in order to offer gradient
   computation. */
   template<FloatingPoint Scalar>
   class Variable {
     friend class Tape<Scalar>;
     friend class Gradient<Scalar>;
+    friend class ParallelTape<Scalar>;
+    friend class Rollout<Scalar>;
+    friend class Matrix<Scalar>;
+
+    template<FloatingPoint S>
+    friend LeafExpression<S> fuse(const Variable<S> &variable);
 
     // Comparison operators
 
@@ -32,39 +56,33 @@ namespace AutoGrad {
 
     /* Equality.
     NOTE: this directly compares two floating-point values using `==` and is therefore unsafe. */
-    template<FloatingPoint S>
-    friend bool operator==(const Variable<S> &variable1, const Variable<S> &variable2) {
+    friend bool operator==(const Variable<Scalar> &variable1, const Variable<Scalar> &variable2) {
       return variable1.val == variable2.val;
     }
 
     /* Inequality.
     NOTE: this directly compares two floating-point values using `!=` and is therefore unsafe. */
-    template<FloatingPoint S>
-    friend bool operator!=(const Variable<S> &variable1, const Variable<S> &variable2) {
+    friend bool operator!=(const Variable<Scalar> &variable1, const Variable<Scalar> &variable2) {
       return variable1.val != variable2.val;
     }
 
     /* Greater than. */
-    template<FloatingPoint S>
-    friend bool operator>(const Variable<S> &variable1, const Variable<S> &variable2) {
+    friend bool operator>(const Variable<Scalar> &variable1, const Variable<Scalar> &variable2) {
       return variable1.val > variable2.val;
     }
 
     /* Less than. */
-    template<FloatingPoint S>
-    friend bool operator<(const Variable<S> &variable1, const Variable<S> &variable2) {
+    friend bool operator<(const Variable<Scalar> &variable1, const Variable<Scalar> &variable2) {
       return variable1.val < variable2.val;
     }
 
     /* Greater than or equal to. */
-    template<FloatingPoint S>
-    friend bool operator>=(const Variable<S> &variable1, const Variable<S> &variable2) {
+    friend bool operator>=(const Variable<Scalar> &variable1, const Variable<Scalar> &variable2) {
       return variable1.val >= variable2.val;
     }
 
     /* Less than or equal to. */
-    template<FloatingPoint S>
-    friend bool operator<=(const Variable<S> &variable1, const Variable<S> &variable2) {
+    friend bool operator<=(const Variable<Scalar> &variable1, const Variable<Scalar> &variable2) {
       return variable1.val <= variable2.val;
     }
 
@@ -78,37 +96,37 @@ namespace AutoGrad {
     friend Variable<S> operator+(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> operator+(const Variable<S> &variable, S scalar);
+    friend Variable<S> operator+(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> operator+(S scalar, const Variable<S> &variable);
+    friend Variable<S> operator+(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     template<FloatingPoint S>
     friend Variable<S> operator-(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> operator-(const Variable<S> &variable, S scalar);
+    friend Variable<S> operator-(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> operator-(S scalar, const Variable<S> &variable);
+    friend Variable<S> operator-(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     template<FloatingPoint S>
     friend Variable<S> operator*(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> operator*(const Variable<S> &variable, S scalar);
+    friend Variable<S> operator*(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> operator*(S scalar, const Variable<S> &variable);
+    friend Variable<S> operator*(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     template<FloatingPoint S>
     friend Variable<S> operator/(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> operator/(const Variable<S> &variable, S scalar);
+    friend Variable<S> operator/(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> operator/(S scalar, const Variable<S> &variable);
+    friend Variable<S> operator/(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     // Exponential and logarithmic functions
 
@@ -116,10 +134,10 @@ namespace AutoGrad {
     friend Variable<S> pow(const Variable<S> &variable1, const Variable<S> &variable2);
 
     template<FloatingPoint S>
-    friend Variable<S> pow(const Variable<S> &variable, S scalar);
+    friend Variable<S> pow(const Variable<S> &variable, std::type_identity_t<S> scalar);
 
     template<FloatingPoint S>
-    friend Variable<S> pow(S scalar, const Variable<S> &variable);
+    friend Variable<S> pow(std::type_identity_t<S> scalar, const Variable<S> &variable);
 
     template<FloatingPoint S>
     friend Variable<S> sqrt(const Variable<S> &variable);
@@ -140,10 +158,10 @@ namespace AutoGrad {
     friend Variable<S> log(const Variable<S> &variable, const Variable<S> &base);
 
     template<FloatingPoint S>
-    friend Variable<S> log(const Variable<S> &variable, S base);
+    friend Variable<S> log(const Variable<S> &variable, std::type_identity_t<S> base);
 
     template<FloatingPoint S>
-    friend Variable<S> log(S scalar, const Variable<S> &base);
+    friend Variable<S> log(std::type_identity_t<S> scalar, const Variable<S> &base);
 
     template<FloatingPoint S>
     friend Variable<S> ln(const Variable<S> &variable);
@@ -235,24 +253,37 @@ namespace AutoGrad {
 
   public:
 
-    /* Construct a new variable object by copying the value of the given one. */
-    Variable(const Variable<Scalar> &variable) noexcept : tape(variable.tape), val{variable.val} {  // Copy constructor
-      index = tape.push_back(1.0, variable.index);
+    /* Construct a new variable object by copying the value of the given one. The copy is recorded as a new node that
+    depends on the original unless `AUTOGRAD_ALIAS_COPIES` is defined, in which case it refers to the same node. */
+    Variable(const Variable<Scalar> &variable) : tape(variable.tape), val{variable.val}, index{tape.copy(variable)} {  // Copy constructor
+#ifndef NDEBUG
+      generation = (index == variable.index) ? variable.generation : tape.generation;
+#endif
     }
 
+    /* Construct a new variable object by recording a fused expression (see `AutoGrad::fuse()`) as a single node whose
+    edges are the partial derivatives of the expression with respect to the variables in it. An expression without
+    variables (e.g. a lone `ConstantExpression`) has no tape to record it on, so it cannot be converted. */
+    template<Expression E>
+      requires std::same_as<typename E::Scalar, Scalar> && (E::leaves > 0)
+    Variable(const E &expression) : Variable(expression, Partials<Scalar, E::leaves>(expression)) {} // Constructor
+
     /* Construct a new variable object by moving the given one. */
     Variable(Variable<Scalar> &&variable) noexcept = default; // Move constructor
 
     // Assignment operators
 
-    /* Reassign a variable object by copying the value of the given one. */
+    /* Reassign a variable object by copying the value of the given one (see the copy constructor). */
     Variable<Scalar> &operator=(const Variable<Scalar> &variable) {
       if (this != &variable) {
         if (&tape != &variable.tape) {
           throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
         }
         val = variable.val;
-        index = tape.push_back(1.0, variable.index);
+        index = tape.copy(variable);
+#ifndef NDEBUG
+        generation = (index == variable.index) ? variable.generation : tape.generation;
+#endif
       }
       return *this;
     }
@@ -264,13 +295,19 @@ namespace AutoGrad {
       }
       val = variable.val;
       index = variable.index;
+#ifndef NDEBUG
+      generation = variable.generation;
+#endif
       return *this;
     }
 
     /* Reassign a variable object using a scalar. */
     Variable<Scalar> &operator=(Scalar scalar) {
       val = scalar;
-      index = tape.push_back();
+      index = tape.leaf(scalar);
+#ifndef NDEBUG
+      generation = tape.generation;
+#endif
       return *this;
     }
 
@@ -322,14 +359,20 @@ namespace AutoGrad {
       return *this;
     }
 
-    /* Identity. */
+    /* Identity (a copy, see the copy constructor). */
     Variable<Scalar> operator+() const {
-      return Variable<Scalar>(tape, val, tape.push_back(1.0, index));
+      return *this;
     }
 
     /* Negation. */
     Variable<Scalar> operator-() const {
-      return Variable<Scalar>(tape, -val, tape.push_back(-1.0, index));
+      return Variable<Scalar>(tape, -val, tape.tracked(*this) ? tape.push_back(Opcodes::unary<Operations::Negation>, -val, -1.0, index) : Tape<Scalar>::passive);
+    }
+
+    /* Determine if the variable is recorded on its tape, i.e. it is not a constant (see `Tape::constant()`) and
+    recording is not paused. */
+    bool active() const noexcept {
+      return tape.tracked(*this);
     }
 
     /* Retrive the actual numerical value. */
@@ -339,24 +382,80 @@ namespace AutoGrad {
 
     /* Compute the gradient: the partial derivatives with respect to all input variables. */
     Gradient<Scalar> gradient() const {
-      size_t size = tape.nodes.size();
-      std::vector<Scalar> gradients(size, 0.0);
-      gradients[index] = 1.0;
-      for (size_t i = size; i-- > 0;) {
-        Node<Scalar> &node = tape.nodes[i];
-        gradients[node.dependencies.first] += node.weights.first * gradients[i];
-        gradients[node.dependencies.second] += node.weights.second * gradients[i];
+      tape.validate(*this);
+      std::vector<Scalar> gradients(tape.size(), 0.0);
+      if (index != Tape<Scalar>::passive) {
+        gradients[index] = 1.0;
+        tape.sweep(gradients, index);
+      }
+      return Gradient<Scalar>(tape, std::move(gradients));
+    }
+
+    /* Compute the gradient by sweeping the tape on the given number of threads in the order given by a schedule (see
+    `Tape::schedule()`), which must have been created since the tape was last modified. */
+    Gradient<Scalar> gradient(const Schedule<Scalar> &schedule, size_t threads = std::max(std::thread::hardware_concurrency(), 1u)) const requires std::floating_point<Scalar> {
+      tape.validate(*this);
+      if (!schedule.describes(tape)) {
+        throw std::invalid_argument("`AutoGrad::Schedule` does not match the current state of the `AutoGrad::Tape`");
+      }
+      std::vector<Scalar> gradients(tape.size(), 0.0);
+      if (index != Tape<Scalar>::passive) {
+        gradients[index] = 1.0;
+        tape.sweep(gradients, index, schedule, threads);
+      }
+      return Gradient<Scalar>(tape, std::move(gradients));
+    }
+
+    /* Compute the partial derivatives with respect to only the given input variables. */
+    Gradient<Scalar> gradient(std::span<const Variable<Scalar>> inputs) const {
+      std::vector<Scalar> adjoints;
+      return gradient(inputs, adjoints);
+    }
+
+    /* Compute the partial derivatives with respect to only the given input variables, using the given buffer for the
+    adjoints of the intermediate variables. The buffer keeps its capacity between calls, so reusing it (on a tape that
+    is rewound to the same size) avoids allocating memory proportional to the size of the tape each time. The sweep
+    also stops at the earliest input rather than continuing to the start of the tape. */
+    Gradient<Scalar> gradient(std::span<const Variable<Scalar>> inputs, std::vector<Scalar> &adjoints) const {
+      tape.validate(*this);
+      Index stop = index;
+      std::vector<Index> indices;
+      indices.reserve(inputs.size());
+      for (const Variable<Scalar> &input : inputs) {
+        if (&tape != &input.tape) {
+          throw std::invalid_argument("`AutoGrad::Variable`s not from the same `AutoGrad::Tape`");
+        }
+        tape.validate(input);
+        stop = std::min(stop, input.index);
+        indices.push_back(input.index);
+      }
+      std::vector<Scalar> gradients(inputs.size(), 0.0);
+      if (index == Tape<Scalar>::passive) {
+        return Gradient<Scalar>(tape, std::move(gradients), std::move(indices));
       }
-      return Gradient<Scalar>(tape, gradients);
+      adjoints.assign(static_cast<size_t>(index) + 1, 0.0);
+      adjoints[index] = 1.0;
+      tape.sweep(adjoints, index, stop);
+      for (size_t input = 0; input < indices.size(); input++) {
+        gradients[input] = (indices[input] <= index) ? adjoints[indices[input]] : 0.0;
+      }
+      return Gradient<Scalar>(tape, std::move(gradients), std::move(indices));
     }
 
   private:
     Tape<Scalar> &tape; // Tape that the variable was created on.
     Scalar val; //  Actual numerical value.
-    size_t index; // Index in the computational graph held by the tape.
+    Index index; // Index in the computational graph held by the tape.
+#ifndef NDEBUG
+    size_t generation = tape.generation; // Generation of the tape in which the node was recorded.
+#endif
 
     /* Construct a variable object for a particular tape given a value and an index. */
-    Variable(Tape<Scalar> &tape_, Scalar value_, size_t index_) noexcept : tape(tape_), val{value_}, index{index_} {} // Constructor
+    Variable(Tape<Scalar> &tape_, Scalar value_, Index index_) noexcept : tape(tape_), val{value_}, index{index_} {} // Constructor
+
+    /* Construct a variable object for the tape of a fused expression given its value and partial derivatives. */
+    template<Expression E, size_t Capacity>
+    Variable(const E &expression, const Partials<Scalar, Capacity> &partials) : tape(*partials.tape), val{expression.value()}, index{tape.push_back(val, std::span<const Scalar>(partials.weights.data(), partials.edges), std::span<const Index>(partials.dependencies.data(), partials.edges))} {} // Constructor
   };
 }
 
@@ -0,0 +1,61 @@
+#ifndef AUTOGRAD_WEIGHT_HPP
+#define AUTOGRAD_WEIGHT_HPP
+
+
+#include "utils.hpp"
+
+namespace AutoGrad {
+
+  /* A 16-bit floating-point number in the bfloat16 format: the exponent range of `float` with 8 bits of precision. It
+  is only a storage type (see `AutoGrad::Weight`), which converts from a scalar by rounding to the nearest even value
+  and to `float` exactly, so any arithmetic on it is done in `float` or wider. */
+  class BFloat16 {
+  public:
+    BFloat16() noexcept = default; // Default constructor
+
+    /* Construct a new bfloat16 number by rounding the given value. */
+    explicit BFloat16(float value) noexcept : bits{round(value)} {} // Constructor
+
+    /* Construct a new bfloat16 number by rounding the given value (first to `float`). */
+    explicit BFloat16(double value) noexcept : BFloat16(static_cast<float>(value)) {} // Constructor
+
+    /* Convert the number to `float` (which is exact). */
+    operator float() const noexcept {
+      return std::bit_cast<float>(static_cast<std::uint32_t>(bits) << 16);
+    }
+
+  private:
+    std::uint16_t bits; // Upper half of the bits of the equivalent `float`.
+
+    /* Round a `float` to the upper half of its bits, to the nearest even value (keeping NaNs quiet). */
+    static std::uint16_t round(float value) noexcept {
+      std::uint32_t word = std::bit_cast<std::uint32_t>(value);
+      if (std::isnan(value)) {
+        return static_cast<std::uint16_t>((word >> 16) | 0x0040);
+      }
+      word += 0x7fff + ((word >> 16) & 1);
+      return static_cast<std::uint16_t>(word >> 16);
+    }
+  };
+
+  /* Type in which a tape stores the partial derivative along each edge for the given scalar type. It is the scalar type
+  itself by default. Define `AUTOGRAD_FLOAT_WEIGHTS` to store them as `float` (which halves the memory of the edges of a
+  `Tape<double>`) or `AUTOGRAD_BFLOAT16_WEIGHTS` to store them as `BFloat16` (a quarter). Values and adjoints are still
+  stored and accumulated in the scalar type, so only the rounding of each partial derivative is lost: the relative
+  error of a gradient grows with the number of edges along each path, by about 2^-24 (`float`) or 2^-9 (`BFloat16`)
+  per edge. Lazy tapes (see `Tape::Mode::Lazy`), most of whose edges hold constant operands rather than partial
+derivatives, and tapes of dual numbers (e.g. in `AutoGrad::hessian()`) always store them in full. */
+#if defined(AUTOGRAD_BFLOAT16_WEIGHTS)
+  template<typename Scalar>
+  using Weight = std::conditional_t<std::floating_point<Scalar>, BFloat16, Scalar>;
+#elif defined(AUTOGRAD_FLOAT_WEIGHTS)
+  template<typename Scalar>
+  using Weight = std::conditional_t<std::floating_point<Scalar> && (sizeof(Scalar) > sizeof(float)), float, Scalar>;
+#else
+  template<typename Scalar>
+  using Weight = Scalar;
+#endif
+}
+
+
+#endif // AUTOGRAD_WEIGHT_HPP